@@ -1,68 +1,79 @@
 #include <bits/stdc++.h>
+#include "../graph_io.hpp"
+#include "../priority_queues.hpp"
+#include "../components.hpp"
 using namespace std;
 
-struct Edge {
-    int u, v;
-    double weight;
-};
+// Undirected weighted graph in CSR form (see csr_graph.hpp)
+using Edge = csr::Edge;
+using Graph = csr::Graph;
 
-struct Graph {
-    int V;
-    vector<vector<pair<int,double>>> adj;
+// Each undirected edge once (u < v)
+vector<Edge> edge_list(Graph &g) {
     vector<Edge> edges;
+    for(int u=0; u<g.num_vertices(); u++)
+        for(uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++)
+            if(u < g.target(a))
+                edges.push_back({u, g.target(a), g.weight(a)});
+    return edges;
+}
 
-    Graph(int V) {
-        this->V = V;
-        adj.resize(V);
-    }
-
-    void add_edge(int u, int v, double w) {
-        adj[u].push_back({v,w});
-        adj[v].push_back({u,w}); // undirected
-        edges.push_back({u,v,w});
-    }
-
-    void save_edges(string filename) {
-        ofstream fout(filename);
-        for(auto &e: edges)
-            fout << e.u << " " << e.v << " " << e.weight << "\n";
-        fout.close();
-    }
-};
+void save_edges(Graph &g, string filename) {
+    ofstream fout(filename);
+    for(auto &e: edge_list(g))
+        fout << e.u << " " << e.v << " " << e.weight << "\n";
+    fout.close();
+}
 
 // ----------------- Prim's Algorithm -----------------
-vector<Edge> prim_mst(Graph &g) {
-    int V = g.V;
+// Grown from the smallest vertex of every connected component, so a
+// disconnected graph gets a spanning forest (as from Kruskal)
+template <class Queue>
+vector<Edge> prim_mst(Graph &g, Queue &pq) {
+    int V = g.num_vertices();
     vector<bool> inMST(V,false);
     vector<double> key(V,1e9);
     vector<int> parent(V,-1);
-    key[0] = 0;
-
-    auto cmp = [](pair<double,int> a, pair<double,int> b){ return a.first > b.first; };
-    priority_queue<pair<double,int>, vector<pair<double,int>>, decltype(cmp)> pq(cmp);
-    pq.push({0,0});
+    Components cc = Components::of(g);
+    for(int c=0; c<cc.count; c++) {
+        int root = cc.members(c)[0];
+        key[root] = 0;
+        pq.update(root, 0);
+    }
 
     while(!pq.empty()) {
-        int u = pq.top().second; pq.pop();
+        int u = pq.pop().second;
         if(inMST[u]) continue;
         inMST[u] = true;
 
-        for(auto &p : g.adj[u]) {
-            int v = p.first; double w = p.second;
+        for(uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            int v = g.target(a); double w = g.weight(a);
             if(!inMST[v] && w < key[v]) {
                 key[v] = w;
                 parent[v] = u;
-                pq.push({key[v], v});
+                pq.update(v, key[v]);
             }
         }
     }
 
     vector<Edge> mst;
-    for(int v=1; v<V; v++)
-        mst.push_back({parent[v], v, key[v]});
+    for(int v=0; v<V; v++)
+        if(parent[v] >= 0)
+            mst.push_back({parent[v], v, key[v]});
     return mst;
 }
 
+// Prim's keys are edge weights, not monotone, so only the lazy and the
+// indexed heap apply (anything else gets the lazy one)
+vector<Edge> prim_mst(Graph &g, QueueKind queue = LAZY_HEAP) {
+    if(queue == DARY_HEAP) {
+        DaryHeapQueue pq(g.num_vertices());
+        return prim_mst(g, pq);
+    }
+    LazyHeapQueue pq(g.num_vertices());
+    return prim_mst(g, pq);
+}
+
 // ----------------- Kruskal's Algorithm -----------------
 struct DSU {
     vector<int> parent, rank;
@@ -80,9 +91,10 @@ struct DSU {
 
 vector<Edge> kruskal_mst(Graph &g) {
     vector<Edge> mst;
-    sort(g.edges.begin(), g.edges.end(), [](Edge a, Edge b){ return a.weight < b.weight; });
-    DSU dsu(g.V);
-    for(auto &e: g.edges)
+    vector<Edge> edges = edge_list(g);
+    sort(edges.begin(), edges.end(), [](Edge a, Edge b){ return a.weight < b.weight; });
+    DSU dsu(g.num_vertices());
+    for(auto &e: edges)
         if(dsu.unite(e.u,e.v))
             mst.push_back(e);
     return mst;
@@ -97,20 +109,42 @@ void save_mst(vector<Edge> &mst, string filename) {
 }
 
 // ----------------- Main -----------------
-int main() {
-    srand(time(0));
-    int V = 6;
-    Graph g(V);
+void usage(const char* prog) {
+    cerr << "Usage: " << prog << " [--queue lazy|dary] [graph file]\n";
+    cerr << "--queue picks Prim's heap: lazy binary heap or indexed 4-ary heap with decrease-key\n";
+}
 
-    // Random weighted edges
-    for(int i=0;i<V;i++)
-        for(int j=i+1;j<V;j++)
-            if(rand()%2)
-                g.add_edge(i,j, 1+rand()%10);
+int main(int argc, char* argv[]) {
+    srand(time(0));
+    string queue = "lazy", file;
+    for(int i=1; i<argc; i++) {
+        string arg = argv[i];
+        if(arg == "--queue" && i+1 < argc) queue = argv[++i];
+        else if(arg[0] != '-' && file.empty()) file = arg;
+        else { usage(argv[0]); return 1; }
+    }
+    if(queue != "lazy" && queue != "dary") { usage(argv[0]); return 1; }
+
+    Graph g;
+    if(!file.empty()) {
+        // Text edge list or binary CSR file (see graph_io.hpp)
+        try { g = csr::load_graph(file); }
+        catch(const exception &e) { cerr << e.what() << endl; return 1; }
+    } else {
+        int V = 6;
+
+        // Random weighted edges
+        vector<Edge> edges;
+        for(int i=0;i<V;i++)
+            for(int j=i+1;j<V;j++)
+                if(rand()%2)
+                    edges.push_back({i,j, double(1+rand()%10)});
+        g = Graph::build(V, edges);
+    }
 
-    g.save_edges("edges.txt");
+    save_edges(g, "edges.txt");
 
-    auto prim = prim_mst(g);
+    auto prim = prim_mst(g, queue == "dary" ? DARY_HEAP : LAZY_HEAP);
     save_mst(prim, "prim_mst.txt");
 
     auto kruskal = kruskal_mst(g);
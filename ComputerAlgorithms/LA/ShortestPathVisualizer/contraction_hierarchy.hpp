@@ -0,0 +1,611 @@
+#ifndef CONTRACTION_HIERARCHY_HPP
+#define CONTRACTION_HIERARCHY_HPP
+
+// Contraction hierarchies (Geisberger et al.) for repeated s-t queries on
+// undirected graphs with non-negative weights.
+//
+// Preprocessing removes ("contracts") the vertices one by one. Removing v
+// adds a shortcut u-w of weight w(u,v) + w(v,w) for each pair of neighbours
+// whose shortest path might run through v, i.e. when a bounded witness
+// search from u that avoids v finds nothing shorter to w. The contraction
+// order is the rank of a vertex; every arc (original or shortcut) is kept
+// in the list of its lower-ranked end only, giving the upward graph.
+//
+// Ordering is done in parallel rounds: the priority of a vertex is its edge
+// difference (shortcuts it would add minus arcs it removes) plus the number of
+// neighbours already contracted, and each round contracts every vertex that
+// beats all its remaining neighbours. Those vertices are independent, so
+// their witness searches run concurrently against the same graph (minus the
+// whole batch); the shortcuts are then added, and only the neighbours'
+// priorities recomputed.
+//
+// Graphs without small separators (random graphs, unlike road networks) fill
+// up with shortcuts as contraction goes on. Once the remaining vertices
+// average more than core_degree arcs they are left uncontracted as the core:
+// ranked last, with all their arcs among each other kept in both lists.
+//
+// A query runs Dijkstra upward from s and from t (and freely inside the core)
+// and meets at the highest vertex of the shortest path; shortcuts are
+// unpacked through the vertex they bypass. On road-like graphs it settles a
+// few hundred vertices where plain Dijkstra settles a good part of the graph.
+//
+//     ContractionHierarchy ch = ContractionHierarchy::build(g);
+//     ch.save("graph.ch");                       // later: ContractionHierarchy::load("graph.ch")
+//     CHQuery q(ch);                             // one per thread, reused across queries
+//     PathResult r = q.query(s, t);              // r.dist, r.path = {s, ..., t}
+//
+// The hierarchy file is laid out like the CSR container in graph_io.hpp: a
+// 64-byte header followed by 64-byte aligned arrays, mapped on load:
+//
+//     rank     uint32[V]
+//     offsets  uint32[V + 1]     search arcs of v: [offsets[v], offsets[v+1])
+//     targets  int32[arcs]       sorted within each vertex
+//     weights  double[arcs]
+//     middle   int32[arcs]       bypassed vertex of a shortcut, -1 for an edge
+//
+// Errors are reported with std::runtime_error.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../csr_graph.hpp"
+#include "../graph_io.hpp"
+#include "../dary_heap.hpp"
+#include "p2p_query.hpp"
+
+class ContractionHierarchy {
+public:
+    static constexpr char MAGIC[8] = {'C', 'H', 'G', 'R', 'A', 'P', 'H', 0};
+    static constexpr uint32_t VERSION = 1;
+
+    // g must be undirected (each edge stored as two arcs, as build() and
+    // load_graph() do by default). A witness search gives up after settling
+    // witness_limit vertices; that only costs extra shortcuts, never accuracy.
+    static ContractionHierarchy build(const csr::Graph& g, int witness_limit = 500, double core_degree = 30);
+
+    static ContractionHierarchy load(const std::string& filename);
+    void save(const std::string& filename) const;
+
+    int num_vertices() const { return up.num_vertices(); }
+    uint32_t num_arcs() const { return up.num_arcs(); }
+    uint32_t num_shortcuts() const {
+        return (uint32_t)std::count_if(mid_, mid_ + up.num_arcs(), [](int m) { return m >= 0; });
+    }
+    // Uncontracted vertices, ranked last
+    int core_size() const { return core_; }
+
+    // Arcs from each vertex to higher-ranked ones, and between core vertices
+    const csr::Graph& upward() const { return up; }
+    uint32_t rank(int v) const { return rank_[v]; }
+    int middle(uint32_t arc) const { return mid_[arc]; }
+
+    // Appends the original path from x to the adjacent (in the hierarchy)
+    // vertex y, without x itself
+    void unpack(int x, int y, std::vector<int>& path) const {
+        int lo = rank_[x] < rank_[y] ? x : y, hi = lo == x ? y : x;
+        const int* first = up.targets() + up.arc_begin(lo);
+        const int* last = up.targets() + up.arc_end(lo);
+        uint32_t arc = (uint32_t)(std::lower_bound(first, last, hi) - up.targets());
+        int m = mid_[arc];
+        if (m < 0) {
+            path.push_back(y);
+            return;
+        }
+        unpack(x, m, path);
+        unpack(m, y, path);
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t endian_tag;
+        uint64_t num_vertices;
+        uint64_t num_arcs;
+        uint64_t core_size;
+        uint64_t reserved[3];
+    };
+    static_assert(sizeof(Header) == 64, "hierarchy file header must stay 64 bytes");
+
+    struct Layout {
+        uint64_t rank, offsets, targets, weights, middle, end;
+        Layout(uint64_t V, uint64_t arcs) {
+            rank = sizeof(Header);
+            offsets = csr::align64(rank + V * sizeof(uint32_t));
+            targets = csr::align64(offsets + (V + 1) * sizeof(uint32_t));
+            weights = csr::align64(targets + arcs * sizeof(int));
+            middle = csr::align64(weights + arcs * sizeof(double));
+            end = middle + arcs * sizeof(int);
+        }
+    };
+
+    struct Storage {
+        std::vector<uint32_t> rank, offsets;
+        std::vector<int> targets, middle;
+        std::vector<double> weights;
+    };
+
+    csr::Graph up;
+    const uint32_t* rank_ = nullptr;
+    const int* mid_ = nullptr;
+    int core_ = 0;
+    std::shared_ptr<const void> owner_; // keeps rank_ and mid_ alive
+
+    // ----------------- Preprocessing -----------------
+    struct Arc {
+        int to;
+        double w;
+        int mid;
+    };
+
+    // Lowers the arc to `to` if there is one, adds it otherwise
+    static void add_or_lower(std::vector<Arc>& arcs, int to, double w, int mid) {
+        for (Arc& a : arcs)
+            if (a.to == to) {
+                if (w < a.w) a = {to, w, mid};
+                return;
+            }
+        arcs.push_back({to, w, mid});
+    }
+
+    // Bounded Dijkstra in the remaining graph; one per thread. Stops once
+    // every target is settled, past max_dist, or after `limit` vertices.
+    struct WitnessSearch {
+        std::vector<double> dist;
+        std::vector<uint32_t> stamp, target;
+        uint32_t cur = 0;
+        int pending = 0;
+        IndexedDaryHeap<double, 4> heap;
+
+        explicit WitnessSearch(int V) : dist(V), stamp(V, 0), target(V, 0), heap(V) {}
+
+        double get(int v) const { return stamp[v] == cur ? dist[v] : 1e300; }
+
+        // Starts a new search; add_target() the vertices it is for, then run()
+        void start() {
+            if (++cur == 0) {
+                std::fill(stamp.begin(), stamp.end(), 0);
+                std::fill(target.begin(), target.end(), 0);
+                cur = 1;
+            }
+            pending = 0;
+        }
+
+        void add_target(int v) {
+            if (target[v] != cur) pending++;
+            target[v] = cur;
+        }
+
+        void run(const std::vector<std::vector<Arc>>& adj, const std::vector<char>& contracted,
+                 int src, int skip, double max_dist, int limit) {
+            heap.clear();
+            stamp[src] = cur;
+            dist[src] = 0;
+            heap.push(src, 0);
+            for (int settled = 0; !heap.empty() && settled < limit && pending > 0; settled++) {
+                double du = heap.top_key();
+                if (du > max_dist) break;
+                int u = heap.pop();
+                if (target[u] == cur) pending--;
+                for (const Arc& a : adj[u]) {
+                    if (a.to == skip || contracted[a.to]) continue;
+                    double nd = du + a.w;
+                    if (nd >= get(a.to)) continue;
+                    stamp[a.to] = cur;
+                    dist[a.to] = nd;
+                    heap.push_or_decrease(a.to, nd);
+                }
+            }
+        }
+    };
+
+    struct Shortcut {
+        int u, w;
+        double weight;
+    };
+
+    // Shortcuts contracting v would add (into out, if given); returns how many
+    static int find_shortcuts(const std::vector<std::vector<Arc>>& adj, const std::vector<char>& contracted,
+                              int v, WitnessSearch& ws, int limit, std::vector<Shortcut>* out) {
+        const std::vector<Arc>& nb = adj[v];
+        int count = 0;
+        for (size_t i = 0; i < nb.size(); i++) {
+            if (contracted[nb[i].to]) continue;
+            double max_via = -1;
+            ws.start();
+            for (size_t j = i + 1; j < nb.size(); j++)
+                if (!contracted[nb[j].to]) {
+                    max_via = std::max(max_via, nb[i].w + nb[j].w);
+                    ws.add_target(nb[j].to);
+                }
+            if (max_via < 0) continue;
+            ws.run(adj, contracted, nb[i].to, v, max_via, limit);
+            for (size_t j = i + 1; j < nb.size(); j++) {
+                if (contracted[nb[j].to]) continue;
+                double via = nb[i].w + nb[j].w;
+                if (ws.get(nb[j].to) <= via) continue; // witness found
+                count++;
+                if (out) out->push_back({nb[i].to, nb[j].to, via});
+            }
+        }
+        return count;
+    }
+};
+
+inline ContractionHierarchy ContractionHierarchy::build(const csr::Graph& g, int witness_limit, double core_degree) {
+    int V = g.num_vertices();
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+
+    // Mutable adjacency without self loops and parallel edges (CSR lists are
+    // sorted by target, so duplicates are adjacent)
+    std::vector<std::vector<Arc>> adj(V);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int u = 0; u < V; u++)
+        for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            int v = g.target(a);
+            double w = g.weight(a);
+            if (v == u) continue;
+            if (!adj[u].empty() && adj[u].back().to == v) adj[u].back().w = std::min(adj[u].back().w, w);
+            else adj[u].push_back({v, w, -1});
+        }
+
+    std::vector<char> contracted(V, 0);
+    std::vector<int> deleted(V, 0), priority(V);
+    std::vector<WitnessSearch> searches(threads, WitnessSearch(V));
+    auto thread_id = []() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    };
+    auto live_degree = [&](int v) {
+        int d = 0;
+        for (const Arc& a : adj[v]) d += !contracted[a.to];
+        return d;
+    };
+    // Priorities only estimate the shortcuts, so their searches stop much earlier
+    int estimate_limit = std::max(1, witness_limit / 10);
+    auto update_priority = [&](int v) {
+        int shortcuts = find_shortcuts(adj, contracted, v, searches[thread_id()], estimate_limit, nullptr);
+        priority[v] = shortcuts - live_degree(v) + deleted[v];
+    };
+    // Strict order on (priority, hashed id) so that each round picks someone
+    // and ties do not line up along paths or grid rows
+    auto before = [&](int a, int b) {
+        if (priority[a] != priority[b]) return priority[a] < priority[b];
+        uint32_t ha = (uint32_t)a * 2654435761u, hb = (uint32_t)b * 2654435761u;
+        return ha != hb ? ha < hb : a < b;
+    };
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int v = 0; v < V; v++) update_priority(v);
+
+    auto s = std::make_shared<Storage>();
+    s->rank.assign(V, 0);
+    std::vector<std::vector<Arc>> upward(V);
+    std::vector<int> remaining(V), batch, touched;
+    for (int v = 0; v < V; v++) remaining[v] = v;
+    std::vector<char> selected(V, 0), is_touched(V, 0);
+    std::vector<std::vector<Shortcut>> shortcuts;
+    uint32_t next_rank = 0;
+
+    while (!remaining.empty()) {
+        // Stop at a dense core (lists only hold arcs between remaining vertices)
+        uint64_t live_arcs = 0;
+        for (int v : remaining) live_arcs += adj[v].size();
+        if (live_arcs > core_degree * remaining.size()) break;
+
+        // Vertices that come before all their remaining neighbours
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (size_t i = 0; i < remaining.size(); i++) {
+            int v = remaining[i];
+            bool pick = true;
+            for (const Arc& a : adj[v])
+                if (!contracted[a.to] && before(a.to, v)) {
+                    pick = false;
+                    break;
+                }
+            selected[v] = pick;
+        }
+        batch.clear();
+        for (int v : remaining)
+            if (selected[v]) batch.push_back(v);
+
+        // Witness searches for the whole batch at once. They must avoid every
+        // vertex of the batch: two of them sharing a pair of neighbours could
+        // otherwise each serve as the other's (equally long) witness.
+        for (int v : batch) contracted[v] = 1;
+        shortcuts.assign(batch.size(), {});
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < batch.size(); i++) {
+            int v = batch[i];
+            find_shortcuts(adj, contracted, v, searches[thread_id()], witness_limit, &shortcuts[i]);
+            for (const Arc& a : adj[v])
+                if (!contracted[a.to]) upward[v].push_back(a);
+        }
+
+        // Contract: rank the batch, add the shortcuts, collect the neighbours
+        touched.clear();
+        for (size_t i = 0; i < batch.size(); i++) {
+            int v = batch[i];
+            s->rank[v] = next_rank++;
+            for (const Shortcut& sc : shortcuts[i]) {
+                add_or_lower(adj[sc.u], sc.w, sc.weight, v);
+                add_or_lower(adj[sc.w], sc.u, sc.weight, v);
+            }
+            for (const Arc& a : upward[v]) {
+                deleted[a.to]++;
+                if (!is_touched[a.to]) {
+                    is_touched[a.to] = 1;
+                    touched.push_back(a.to);
+                }
+            }
+            std::vector<Arc>().swap(adj[v]);
+        }
+
+        // Drop arcs into the batch, then re-rate the neighbours (two passes:
+        // witness searches read the lists the first pass edits)
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (size_t i = 0; i < touched.size(); i++) {
+            int u = touched[i];
+            is_touched[u] = 0;
+            auto& arcs = adj[u];
+            arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [&](const Arc& a) { return contracted[a.to]; }),
+                       arcs.end());
+        }
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (size_t i = 0; i < touched.size(); i++) update_priority(touched[i]);
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](int v) { return contracted[v]; }),
+                        remaining.end());
+    }
+
+    for (int v : remaining) {
+        s->rank[v] = next_rank++;
+        upward[v] = adj[v];
+    }
+
+    // Search arcs into CSR, each list sorted by target for unpack()
+    s->offsets.assign(V + 1, 0);
+    for (int v = 0; v < V; v++) s->offsets[v + 1] = s->offsets[v] + (uint32_t)upward[v].size();
+    uint32_t arcs = s->offsets[V];
+    s->targets.resize(arcs);
+    s->weights.resize(arcs);
+    s->middle.resize(arcs);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int v = 0; v < V; v++) {
+        auto& list = upward[v];
+        std::sort(list.begin(), list.end(), [](const Arc& a, const Arc& b) { return a.to < b.to; });
+        for (size_t i = 0; i < list.size(); i++) {
+            uint32_t a = s->offsets[v] + (uint32_t)i;
+            s->targets[a] = list[i].to;
+            s->weights[a] = list[i].w;
+            s->middle[a] = list[i].mid;
+        }
+    }
+
+    ContractionHierarchy ch;
+    ch.up = csr::Graph::view(V, arcs, s->offsets.data(), s->targets.data(), s->weights.data(), s);
+    ch.rank_ = s->rank.data();
+    ch.mid_ = s->middle.data();
+    ch.core_ = (int)remaining.size();
+    ch.owner_ = s;
+    return ch;
+}
+
+// ----------------- Hierarchy files -----------------
+inline void ContractionHierarchy::save(const std::string& filename) const {
+    uint64_t V = num_vertices(), arcs = num_arcs();
+    Layout pos(V, arcs);
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.endian_tag = csr::ENDIAN_TAG;
+    h.num_vertices = V;
+    h.num_arcs = arcs;
+    h.core_size = core_;
+
+    std::ofstream f(filename, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot create " + filename);
+    auto write_at = [&](uint64_t at, const void* p, uint64_t bytes) {
+        static const char zeros[64] = {};
+        f.write(zeros, at - (uint64_t)f.tellp()); // alignment padding
+        f.write((const char*)p, bytes);
+    };
+    f.write((const char*)&h, sizeof(h));
+    write_at(pos.rank, rank_, V * sizeof(uint32_t));
+    write_at(pos.offsets, up.offsets(), (V + 1) * sizeof(uint32_t));
+    write_at(pos.targets, up.targets(), arcs * sizeof(int));
+    write_at(pos.weights, up.weights(), arcs * sizeof(double));
+    write_at(pos.middle, mid_, arcs * sizeof(int));
+    if (!f) throw std::runtime_error("write failed: " + filename);
+}
+
+inline ContractionHierarchy ContractionHierarchy::load(const std::string& filename) {
+    auto file = std::make_shared<csr::MappedFile>(filename);
+    auto fail = [&](const std::string& why) { throw std::runtime_error(filename + ": " + why); };
+    if (file->size() < sizeof(Header)) fail("too small for a hierarchy header");
+    Header h;
+    memcpy(&h, file->data(), sizeof(h));
+    if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) fail("not a contraction hierarchy file");
+    if (h.endian_tag != csr::ENDIAN_TAG) fail("written on a machine with a different byte order");
+    if (h.version != VERSION) fail("unsupported version " + std::to_string(h.version));
+    if (h.num_vertices > (uint64_t)INT_MAX || h.num_arcs > UINT32_MAX) fail("hierarchy too large");
+    if (h.core_size > h.num_vertices) fail("core larger than the graph");
+    Layout pos(h.num_vertices, h.num_arcs);
+    if (pos.end > file->size()) fail("truncated");
+
+    const char* base = file->data();
+    const uint32_t* offsets = (const uint32_t*)(base + pos.offsets);
+    const int* targets = (const int*)(base + pos.targets);
+    const uint32_t* rank = (const uint32_t*)(base + pos.rank);
+    const int* middle = (const int*)(base + pos.middle);
+    if (offsets[0] != 0 || offsets[h.num_vertices] != h.num_arcs) fail("offsets do not match the arc count");
+
+    // Queries and unpack() index with all of the arrays, so they are checked
+    // as in csr::load_binary: first each vertex's arc range, targets and rank
+    int V = (int)h.num_vertices;
+    uint32_t arcs = (uint32_t)h.num_arcs;
+    long long bad_offsets = 0, bad_targets = 0, bad_ranks = 0;
+    std::vector<char> ranked(V, 0);
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : bad_offsets, bad_targets, bad_ranks)
+    for (int u = 0; u < V; u++) {
+        if (rank[u] >= (uint32_t)V || __atomic_exchange_n(&ranked[rank[u]], 1, __ATOMIC_RELAXED)) bad_ranks++;
+        uint32_t lo = offsets[u], hi = offsets[u + 1];
+        if (lo > hi || hi > arcs) {
+            bad_offsets++;
+            continue;
+        }
+        for (uint32_t a = lo; a < hi; a++)
+            if ((uint32_t)targets[a] >= (uint32_t)V || (a > lo && targets[a] < targets[a - 1])) bad_targets++;
+    }
+    if (bad_offsets) fail("offsets are not non-decreasing");
+    if (bad_targets) fail(std::to_string(bad_targets) + " arc targets unsorted or outside [0, V)");
+    if (bad_ranks) fail("ranks are not a permutation of [0, V)");
+
+    // Then the hierarchy itself: arcs go up in rank (or stay inside the core,
+    // stored both ways), and a shortcut's middle is ranked below both ends
+    // with both halves present, so unpack() always finds its arc and ends
+    uint32_t core_rank = (uint32_t)(h.num_vertices - h.core_size);
+    auto has_arc = [&](int x, int y) { // in the list of the lower-ranked end, as unpack() looks
+        if (rank[x] > rank[y]) std::swap(x, y);
+        const int* first = targets + offsets[x];
+        const int* last = targets + offsets[x + 1];
+        const int* it = std::lower_bound(first, last, y);
+        return it != last && *it == y;
+    };
+    long long bad_arcs = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : bad_arcs)
+    for (int u = 0; u < V; u++) {
+        for (uint32_t a = offsets[u]; a < offsets[u + 1]; a++) {
+            int v = targets[a], m = middle[a];
+            bool upward = rank[u] < rank[v] || (rank[u] >= core_rank && rank[v] >= core_rank && has_arc(u, v));
+            bool halves = m == -1 || (m >= 0 && m < V && rank[m] < rank[u] && rank[m] < rank[v] && has_arc(u, m) &&
+                                      has_arc(m, v));
+            if (!upward || !halves) bad_arcs++;
+        }
+    }
+    if (bad_arcs) fail(std::to_string(bad_arcs) + " arcs break the rank order or have an invalid middle");
+
+    ContractionHierarchy ch;
+    ch.up = csr::Graph::view(V, arcs, offsets, targets, (const double*)(base + pos.weights), file);
+    ch.rank_ = rank;
+    ch.mid_ = middle;
+    ch.core_ = (int)h.core_size;
+    ch.owner_ = file;
+    return ch;
+}
+
+// ----------------- Queries -----------------
+// Upward search from both ends (plain bidirectional Dijkstra once inside the
+// core); reusable scratch as in P2PQuery
+class CHQuery {
+public:
+    static constexpr double INF = 1e9;
+
+    explicit CHQuery(const ContractionHierarchy& ch) : ch(ch) {
+        int V = ch.num_vertices();
+        for (Side& side : sides) {
+            side.dist.resize(V);
+            side.parent.resize(V);
+            side.stamp.assign(V, 0);
+            side.heap.reset(V);
+        }
+    }
+
+    PathResult query(int s, int t) {
+        PathResult r;
+        int V = ch.num_vertices();
+        if (s < 0 || s >= V || t < 0 || t >= V) return r;
+        if (++stamp == 0) {
+            for (Side& side : sides) std::fill(side.stamp.begin(), side.stamp.end(), 0);
+            stamp = 1;
+        }
+        Side& F = sides[0];
+        Side& B = sides[1];
+        F.heap.clear();
+        B.heap.clear();
+        label(F, s, 0, -1);
+        label(B, t, 0, -1);
+        F.heap.push(s, 0);
+        B.heap.push(t, 0);
+
+        const csr::Graph& up = ch.upward();
+        double best = INF;
+        int meet = -1;
+        while (true) {
+            // A side is done once its queue cannot beat the best meeting
+            bool f_open = !F.heap.empty() && F.heap.top_key() < best;
+            bool b_open = !B.heap.empty() && B.heap.top_key() < best;
+            if (!f_open && !b_open) break;
+            bool forward = f_open && (!b_open || F.heap.top_key() <= B.heap.top_key());
+            Side& S = forward ? F : B;
+            Side& O = forward ? B : F;
+
+            double du = S.heap.top_key();
+            int u = S.heap.pop();
+            r.settled++;
+            if (du + dist(O, u) < best) {
+                best = du + dist(O, u);
+                meet = u;
+            }
+            for (uint32_t a = up.arc_begin(u); a < up.arc_end(u); a++) {
+                int v = up.target(a);
+                double nd = du + up.weight(a);
+                if (nd >= dist(S, v)) continue;
+                label(S, v, nd, u);
+                S.heap.push_or_decrease(v, nd);
+            }
+        }
+        if (meet < 0) return r;
+
+        // s ... meet ... t in the hierarchy, then each hop unpacked
+        r.dist = best;
+        std::vector<int>& hops = scratch;
+        hops.clear();
+        for (int v = meet; v != -1; v = F.parent[v]) hops.push_back(v);
+        std::reverse(hops.begin(), hops.end());
+        for (int v = B.parent[meet]; v != -1; v = B.parent[v]) hops.push_back(v);
+        r.path.push_back(s);
+        for (size_t i = 1; i < hops.size(); i++) ch.unpack(hops[i - 1], hops[i], r.path);
+        return r;
+    }
+
+private:
+    struct Side {
+        std::vector<double> dist;
+        std::vector<int> parent;
+        std::vector<uint32_t> stamp; // dist/parent are valid iff stamp == the query's
+        IndexedDaryHeap<double, 4> heap;
+    };
+
+    const ContractionHierarchy& ch;
+    Side sides[2];
+    std::vector<int> scratch;
+    uint32_t stamp = 0;
+
+    double dist(const Side& side, int v) const { return side.stamp[v] == stamp ? side.dist[v] : INF; }
+
+    void label(Side& side, int v, double d, int parent) {
+        side.stamp[v] = stamp;
+        side.dist[v] = d;
+        side.parent[v] = parent;
+    }
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef DELTA_STEPPING_HPP
+#define DELTA_STEPPING_HPP
+
+// Parallel single-source shortest paths by delta-stepping (Meyer & Sanders).
+//
+// Tentative distances are grouped into buckets of width delta. The smallest
+// non-empty bucket is settled in rounds: all threads relax the light arcs
+// (weight <= delta) of its vertices, which can only refill the same or later
+// buckets, until it stays empty; then the heavy arcs of every vertex settled
+// in it are relaxed once. Each thread keeps its own buckets, so the only
+// shared writes are the distance updates themselves (a per-vertex spin lock
+// keeps dist and parent consistent; most relaxations fail a plain check first).
+//
+// dist/parent match dijkstra() in graph_analysis.cpp: unreachable vertices
+// keep 1e9 and -1. On ties a different shortest-path parent may be chosen.
+// Weights must be non-negative.
+//
+//     vector<int> parent;
+//     vector<double> dist = delta_stepping(g, src, parent);          // tuned delta
+//     vector<double> dist = delta_stepping(g, src, parent, 5.0);     // fixed delta
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../csr_graph.hpp"
+
+// Bucket width from the weight distribution: light arcs should be few per
+// vertex, so delta ~ (95th percentile weight) / (average degree), but never
+// below the smallest positive weight (each bucket then does real work).
+inline double choose_delta(const csr::Graph& g) {
+    if (g.num_arcs() == 0 || g.num_vertices() == 0) return 1.0;
+    if (!g.weighted()) return 1.0;
+    const uint32_t SAMPLES = 100000;
+    uint32_t step = std::max<uint32_t>(1, g.num_arcs() / SAMPLES);
+    std::vector<double> w;
+    double min_positive = 0;
+    for (uint32_t a = 0; a < g.num_arcs(); a += step) {
+        double x = g.weight(a);
+        w.push_back(x);
+        if (x > 0 && (min_positive == 0 || x < min_positive)) min_positive = x;
+    }
+    size_t k = w.size() * 95 / 100;
+    std::nth_element(w.begin(), w.begin() + k, w.end());
+    double avg_degree = (double)g.num_arcs() / g.num_vertices();
+    double delta = w[k] / std::max(1.0, avg_degree);
+    return std::max(delta, min_positive > 0 ? min_positive : 1.0);
+}
+
+inline std::vector<double> delta_stepping(const csr::Graph& g, int src, std::vector<int>& parent, double delta = 0) {
+    const double INF = 1e9;
+    const size_t NONE = SIZE_MAX;
+    int V = g.num_vertices();
+    std::vector<double> dist(V, INF);
+    parent.assign(V, -1);
+    if (src < 0 || src >= V) return dist;
+    if (delta <= 0) delta = choose_delta(g);
+
+    std::vector<char> lock(V, 0);
+    std::vector<size_t> settled_in(V, NONE); // bucket a vertex was last settled in
+    double* d = dist.data();
+    int* par = parent.data();
+    auto load = [d](int v) { double x; __atomic_load(&d[v], &x, __ATOMIC_RELAXED); return x; };
+    auto bucket_of = [delta](double x) { return (size_t)(x / delta); };
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    // Sized by the team that actually runs, which can be smaller than asked
+    // for (OMP_THREAD_LIMIT, OMP_DYNAMIC, nested regions)
+    int team = 1;
+    std::vector<std::vector<std::vector<int>>> bins; // bins[thread][bucket]
+    std::vector<size_t> next_bucket;
+    std::vector<size_t> gather_pos;
+    std::vector<int> frontier = {src};
+    size_t cur = 0;
+    d[src] = 0;
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        #pragma omp single
+        {
+#ifdef _OPENMP
+            team = omp_get_num_threads();
+#endif
+            bins.resize(team);
+            next_bucket.assign(team, NONE);
+            gather_pos.assign(team + 1, 0);
+        }
+        std::vector<std::vector<int>>& my_bins = bins[t];
+        std::vector<int> settled;
+
+        // Lower dist[v] to nd if that is an improvement; file v under its new bucket
+        auto relax = [&](int u, int v, double nd) {
+            if (nd >= load(v)) return;
+            while (__atomic_test_and_set(&lock[v], __ATOMIC_ACQUIRE)) {}
+            bool improved = nd < d[v];
+            if (improved) {
+                __atomic_store(&d[v], &nd, __ATOMIC_RELAXED);
+                par[v] = u;
+            }
+            __atomic_clear(&lock[v], __ATOMIC_RELEASE);
+            if (!improved) return;
+            size_t b = bucket_of(nd);
+            if (b >= my_bins.size()) my_bins.resize(b + 1);
+            my_bins[b].push_back(v);
+        };
+
+        // frontier = every thread's bins[cur], emptied
+        auto gather = [&]() {
+            #pragma omp barrier
+            #pragma omp single
+            {
+                gather_pos[0] = 0;
+                for (int i = 0; i < team; i++)
+                    gather_pos[i + 1] = gather_pos[i] + (cur < bins[i].size() ? bins[i][cur].size() : 0);
+                frontier.resize(gather_pos[team]);
+            }
+            if (cur < my_bins.size()) {
+                std::copy(my_bins[cur].begin(), my_bins[cur].end(), frontier.begin() + gather_pos[t]);
+                my_bins[cur].clear();
+            }
+            #pragma omp barrier
+        };
+
+        while (true) {
+            // Light phase: settle bucket cur, which may refill itself
+            while (!frontier.empty()) {
+                #pragma omp for schedule(dynamic, 64) nowait
+                for (size_t i = 0; i < frontier.size(); i++) {
+                    int u = frontier[i];
+                    double du = load(u);
+                    if (bucket_of(du) != cur) continue; // stale entry
+                    if (__atomic_exchange_n(&settled_in[u], cur, __ATOMIC_RELAXED) != cur)
+                        settled.push_back(u);
+                    for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++)
+                        if (g.weight(a) <= delta) relax(u, g.target(a), du + g.weight(a));
+                }
+                gather();
+            }
+
+            // Heavy phase: each settled vertex once, its distance is final now
+            for (int u : settled) {
+                double du = load(u);
+                for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++)
+                    if (g.weight(a) > delta) relax(u, g.target(a), du + g.weight(a));
+            }
+            settled.clear();
+
+            // Next non-empty bucket over all threads
+            size_t b = cur + 1;
+            while (b < my_bins.size() && my_bins[b].empty()) b++;
+            next_bucket[t] = b < my_bins.size() ? b : NONE;
+            #pragma omp barrier
+            #pragma omp single
+            cur = *std::min_element(next_bucket.begin(), next_bucket.end());
+            if (cur == NONE) break;
+            gather();
+        }
+    }
+    return dist;
+}
+
+#endif
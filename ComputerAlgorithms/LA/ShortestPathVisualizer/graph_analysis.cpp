@@ -1,90 +1,381 @@
 #include <bits/stdc++.h>
+#include "../graph_io.hpp"
+#include "../priority_queues.hpp"
+#include "../bfs.hpp"
+#include "delta_stepping.hpp"
+#include "p2p_query.hpp"
+#include "contraction_hierarchy.hpp"
 using namespace std;
 
-struct Edge { int to; double weight; };
+// Undirected weighted graph in CSR form (see csr_graph.hpp)
+using Graph = csr::Graph;
 
-struct Graph {
-    int V;
-    vector<vector<Edge>> adj;
+// ----------------- Queue choice -----------------
+// The queues (priority_queues.hpp) get update(v, d) when v's tentative
+// distance drops to d; the lazy ones leave stale entries for dijkstra to skip.
 
-    Graph(int V) {
-        this->V = V;
-        adj.resize(V);
+// Largest weight if all weights are non-negative integers below 2^32, else -1
+long long max_integer_weight(const Graph &g) {
+    long long max_w = 0;
+    for(uint32_t a = 0; a < g.num_arcs(); a++) {
+        double w = g.weight(a);
+        if(!(w >= 0 && w < 4294967296.0) || w != floor(w)) return -1;
+        max_w = max(max_w, (long long)w);
     }
+    return max_w;
+}
 
-    void add_edge(int u, int v, double w) {
-        adj[u].push_back({v,w});
-        adj[v].push_back({u,w}); // undirected
-    }
-};
+// The weight shared by every arc, or -1 if they differ (or are negative);
+// such graphs are solved by BFS
+double uniform_weight(const Graph &g) {
+    if(g.num_arcs() == 0) return 1;
+    double w = g.weight(0);
+    for(uint32_t a = 1; a < g.num_arcs(); a++)
+        if(g.weight(a) != w) return -1;
+    return w >= 0 ? w : -1;
+}
+
+// Dial's buckets for small integer weights (one bucket per weight value),
+// the radix heap for larger ones, the binary heap for anything else
+const long long DIAL_MAX_WEIGHT = 1 << 12;
+
+QueueKind choose_queue(const Graph &g) {
+    long long max_w = max_integer_weight(g);
+    if(max_w < 0) return LAZY_HEAP;
+    return max_w <= DIAL_MAX_WEIGHT ? DIAL_BUCKETS : RADIX_HEAP;
+}
 
 // ----------------- Dijkstra -----------------
-vector<double> dijkstra(Graph &g, int src, vector<int> &parent) {
-    int V = g.V;
-    vector<double> dist(V, 1e9);
+// Fills dist and parent, reusing their storage and the queue's across calls
+template <class Queue>
+void dijkstra(Graph &g, int src, vector<double> &dist, vector<int> &parent, Queue &pq) {
+    int V = g.num_vertices();
+    dist.assign(V, 1e9);
     parent.assign(V, -1);
+    pq.clear();
     dist[src] = 0;
-
-    using P = pair<double,int>;
-    priority_queue<P, vector<P>, greater<P>> pq;
-    pq.push({0, src});
+    pq.update(src, 0);
 
     while(!pq.empty()) {
-        auto [d,u] = pq.top(); pq.pop();
-        if(d > dist[u]) continue;
+        auto [d,u] = pq.pop();
+        if(d > dist[u]) continue; // stale entry (lazy heap only)
 
-        for(auto &e : g.adj[u]) {
-            int v = e.to;
-            double w = e.weight;
+        for(uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            int v = g.target(a);
+            double w = g.weight(a);
             if(dist[u] + w < dist[v]) {
                 dist[v] = dist[u] + w;
                 parent[v] = u;
-                pq.push({dist[v], v});
+                pq.update(v, dist[v]);
             }
         }
     }
-    return dist;
 }
 
 // ----------------- Save Graph & Shortest Paths -----------------
 void save_graph(Graph &g, string filename) {
     ofstream fout(filename);
-    for(int u=0; u<g.V; u++)
-        for(auto &e : g.adj[u])
-            if(u < e.to)
-                fout << u << " " << e.to << " " << e.weight << "\n";
+    for(int u=0; u<g.num_vertices(); u++)
+        for(uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++)
+            if(u < g.target(a))
+                fout << u << " " << g.target(a) << " " << g.weight(a) << "\n";
     fout.close();
 }
 
-void save_shortest_paths(int src, const vector<double> &dist, const vector<int> &parent, string filename) {
-    ofstream fout(filename, ios::app);
-    fout << "Source: " << src << "\n";
-    for(int v=0; v<dist.size(); v++)
-        fout << v << " " << dist[v] << " " << parent[v] << "\n";
-    fout << "\n";
-    fout.close();
+// Text record: "Source: s", one "v dist parent" line per vertex, a blank line.
+// Doubles are printed like ostream's default (6 significant digits).
+void format_shortest_paths(int src, const vector<double> &dist, const vector<int> &parent, string &out) {
+    char buf[32];
+    auto put = [&](auto x, auto... fmt) { out.append(buf, to_chars(buf, buf + sizeof buf, x, fmt...).ptr); };
+    out += "Source: ";
+    put(src);
+    out += "\n";
+    for(size_t v=0; v<dist.size(); v++) {
+        put(v);
+        out += ' ';
+        put(dist[v], chars_format::general, 6);
+        out += ' ';
+        put(parent[v]);
+        out += '\n';
+    }
+    out += "\n";
+}
+
+// Binary file: a 32-byte header, then one record per source in run order
+//   header: char magic[8] = "SSSPDIST", uint32 version, endian tag, V, sources, 8 bytes zero
+//   record: int32 source, double dist[V] (1e9 = unreachable), int32 parent[V] (-1 = none)
+const char PATHS_MAGIC[8] = {'S','S','S','P','D','I','S','T'};
+const uint32_t PATHS_VERSION = 1;
+
+void format_shortest_paths_binary(int src, const vector<double> &dist, const vector<int> &parent, string &out) {
+    int32_t s = src;
+    out.append((const char*)&s, sizeof s);
+    out.append((const char*)dist.data(), dist.size() * sizeof(double));
+    out.append((const char*)parent.data(), parent.size() * sizeof(int32_t));
+}
+
+// Opens the output once with a large buffer; records are appended in order.
+// Text output appends to an existing file, binary output replaces it.
+class PathWriter {
+public:
+    PathWriter(const string &filename, bool binary, int V, int sources) : filename(filename) {
+        f = fopen(filename.c_str(), binary ? "wb" : "a");
+        if(!f) throw runtime_error("cannot open " + filename);
+        setvbuf(f, nullptr, _IOFBF, 1 << 22);
+        if(binary) {
+            uint32_t fields[6] = {PATHS_VERSION, csr::ENDIAN_TAG, uint32_t(V), uint32_t(sources), 0, 0};
+            fwrite(PATHS_MAGIC, 1, sizeof PATHS_MAGIC, f);
+            fwrite(fields, sizeof fields, 1, f);
+        }
+    }
+    ~PathWriter() { if(f) fclose(f); }
+
+    void write(const string &record) { fwrite(record.data(), 1, record.size(), f); }
+
+    // Flushes and reports any write error
+    void close() {
+        bool failed = ferror(f) != 0;
+        failed |= fclose(f) != 0;
+        f = nullptr;
+        if(failed) throw runtime_error("error writing " + filename);
+    }
+
+private:
+    FILE *f;
+    string filename;
+};
+
+// ----------------- Multi-source runs -----------------
+// Runs every source on a pool of OpenMP threads. Each worker owns a solver
+// from make_solver() (with its own queue) and its own dist/parent/record
+// buffers, so nothing is allocated per source once they have grown; records
+// reach the writer in source order.
+template <class MakeSolver>
+void run_sources(const vector<int> &sources, MakeSolver make_solver, bool binary, PathWriter &out, bool parallel = true) {
+    #pragma omp parallel if(parallel)
+    {
+        auto solve = make_solver();
+        vector<double> dist;
+        vector<int> parent;
+        string record;
+
+        #pragma omp for ordered schedule(dynamic, 1)
+        for(size_t i=0; i<sources.size(); i++) {
+            solve(sources[i], dist, parent);
+            record.clear();
+            if(binary) format_shortest_paths_binary(sources[i], dist, parent, record);
+            else format_shortest_paths(sources[i], dist, parent, record);
+            #pragma omp ordered
+            out.write(record);
+        }
+    }
+}
+
+template <class Queue, class... Args>
+void run_dijkstra(Graph &g, const vector<int> &sources, bool binary, PathWriter &out, Args... queue_args) {
+    auto make_solver = [&]() {
+        return [&g, pq = Queue(queue_args...)](int src, vector<double> &dist, vector<int> &parent) mutable {
+            dijkstra(g, src, dist, parent, pq);
+        };
+    };
+    run_sources(sources, make_solver, binary, out);
+}
+
+void run_dijkstra(Graph &g, const vector<int> &sources, QueueKind queue, bool binary, PathWriter &out) {
+    if(queue == AUTO_QUEUE) queue = choose_queue(g);
+    int V = g.num_vertices();
+    switch(queue) {
+        case DARY_HEAP: run_dijkstra<DaryHeapQueue>(g, sources, binary, out, V); break;
+        case DIAL_BUCKETS: run_dijkstra<DialQueue>(g, sources, binary, out, (uint64_t)max_integer_weight(g)); break;
+        case RADIX_HEAP: run_dijkstra<RadixQueue>(g, sources, binary, out, V); break;
+        default: run_dijkstra<LazyHeapQueue>(g, sources, binary, out, V); break;
+    }
+}
+
+// delta-stepping is parallel itself, so its sources run one after another
+void run_delta_stepping(Graph &g, const vector<int> &sources, double delta, bool binary, PathWriter &out) {
+    auto make_solver = [&]() {
+        return [&](int src, vector<double> &dist, vector<int> &parent) { dist = delta_stepping(g, src, parent, delta); };
+    };
+    run_sources(sources, make_solver, binary, out, false);
+}
+
+// Direction-optimizing BFS (bfs.hpp) for graphs whose arcs all weigh w: the
+// distance is w times the hops. Parallel itself, like delta-stepping.
+void run_bfs(Graph &g, const vector<int> &sources, double w, bool binary, PathWriter &out) {
+    auto make_solver = [&]() {
+        return [&g, w, bfs = BFS(g)](int src, vector<double> &dist, vector<int> &parent) mutable {
+            const BFSResult &r = bfs.run(src);
+            int V = g.num_vertices();
+            dist.resize(V);
+            for(int v=0; v<V; v++) dist[v] = r.level[v] < 0 ? 1e9 : r.level[v] * w;
+            parent = r.parent;
+        };
+    };
+    run_sources(sources, make_solver, binary, out, false);
+}
+
+// "all" or comma-separated vertex ids
+bool parse_sources(const string &spec, int V, vector<int> &sources) {
+    sources.clear();
+    if(spec == "all") {
+        for(int v=0; v<V; v++) sources.push_back(v);
+        return true;
+    }
+    stringstream ss(spec);
+    string item;
+    while(getline(ss, item, ',')) {
+        int v;
+        auto [end, ec] = from_chars(item.data(), item.data() + item.size(), v);
+        if(ec != errc() || end != item.data() + item.size() || v < 0 || v >= V) return false;
+        sources.push_back(v);
+    }
+    return !sources.empty();
+}
+
+void print_path(int s, int t, const PathResult &r) {
+    cout << "Shortest path " << s << " -> " << t << ": ";
+    if(r.path.empty()) { cout << "unreachable\n"; return; }
+    cout << r.dist << " via";
+    for(int v : r.path) cout << " " << v;
+    cout << "\n";
+}
+
+// Answers the queries from a contraction hierarchy
+int run_ch_queries(const ContractionHierarchy &ch, const vector<pair<int,int>> &queries) {
+    CHQuery query(ch);
+    for(auto [s,t] : queries) {
+        if(s < 0 || s >= ch.num_vertices() || t < 0 || t >= ch.num_vertices()) {
+            cerr << "--query: vertices must be in [0, " << ch.num_vertices() << ")" << endl;
+            return 1;
+        }
+        print_path(s, t, query.query(s, t));
+    }
+    return 0;
 }
 
 // ----------------- Main -----------------
-int main() {
+void usage(const char* prog) {
+    cerr << "Usage: " << prog << " [--algo dijkstra|delta|bfs] [--queue auto|lazy|dary|dial|radix] [--delta D]\n";
+    cerr << "       [--sources all|v1,v2,...] [--format text|binary] [--out FILE] [graph file]\n";
+    cerr << "       " << prog << " --query S T [--query S T ...] [graph file]\n";
+    cerr << "       " << prog << " --ch-build CH_FILE [--query S T ...] [graph file]\n";
+    cerr << "       " << prog << " --ch CH_FILE --query S T [--query S T ...]\n";
+    cerr << "--queue picks dijkstra's priority queue: lazy binary heap, indexed 4-ary heap with decrease-key,\n";
+    cerr << "        Dial's buckets or radix heap (integer weights only); auto picks from the weights\n";
+    cerr << "--algo delta runs parallel delta-stepping; D defaults to a value tuned from the weights\n";
+    cerr << "--algo bfs runs direction-optimizing BFS; all edges must have the same weight\n";
+    cerr << "Sources run in parallel; paths go to shortest_paths.txt (appended) or shortest_paths.bin\n";
+    cerr << "--query prints the S-T distance and path from bidirectional dijkstra instead\n";
+    cerr << "--ch-build preprocesses the graph into a contraction hierarchy file; --ch answers queries from one\n";
+}
+
+int main(int argc, char* argv[]) {
     srand(time(0));
-    int V = 6;
-    Graph g(V);
+    string algo = "dijkstra", queue = "auto", file, sources_spec = "all", format = "text", out_file;
+    string ch_build, ch_file;
+    double delta = 0;
+    vector<pair<int,int>> queries;
+    for(int i=1; i<argc; i++) {
+        string arg = argv[i];
+        if(arg == "--algo" && i+1 < argc) algo = argv[++i];
+        else if(arg == "--queue" && i+1 < argc) queue = argv[++i];
+        else if(arg == "--delta" && i+1 < argc) delta = atof(argv[++i]);
+        else if(arg == "--sources" && i+1 < argc) sources_spec = argv[++i];
+        else if(arg == "--format" && i+1 < argc) format = argv[++i];
+        else if(arg == "--out" && i+1 < argc) out_file = argv[++i];
+        else if(arg == "--ch-build" && i+1 < argc) ch_build = argv[++i];
+        else if(arg == "--ch" && i+1 < argc) ch_file = argv[++i];
+        else if(arg == "--query" && i+2 < argc) { queries.push_back({atoi(argv[i+1]), atoi(argv[i+2])}); i += 2; }
+        else if(arg[0] != '-' && file.empty()) file = arg;
+        else { usage(argv[0]); return 1; }
+    }
+    if(algo != "dijkstra" && algo != "delta" && algo != "bfs") { usage(argv[0]); return 1; }
+    map<string, QueueKind> queue_kinds = {{"auto", AUTO_QUEUE}, {"lazy", LAZY_HEAP}, {"dary", DARY_HEAP},
+                                          {"dial", DIAL_BUCKETS}, {"radix", RADIX_HEAP}};
+    if(!queue_kinds.count(queue)) { usage(argv[0]); return 1; }
+    if(format != "text" && format != "binary") { usage(argv[0]); return 1; }
+    bool binary = format == "binary";
+    if(out_file.empty()) out_file = binary ? "shortest_paths.bin" : "shortest_paths.txt";
+    QueueKind queue_kind = queue_kinds[queue];
 
-    // Random weighted edges
-    for(int i=0;i<V;i++)
-        for(int j=i+1;j<V;j++)
-            if(rand()%2)
-                g.add_edge(i,j, 1+rand()%10);
+    if(!ch_file.empty()) {
+        if(queries.empty() || !file.empty()) { usage(argv[0]); return 1; }
+        try { return run_ch_queries(ContractionHierarchy::load(ch_file), queries); }
+        catch(const exception &e) { cerr << e.what() << endl; return 1; }
+    }
 
-    save_graph(g, "edges.txt");
+    Graph g;
+    if(!file.empty()) {
+        // Text edge list or binary CSR file (see graph_io.hpp)
+        try { g = csr::load_graph(file); }
+        catch(const exception &e) { cerr << e.what() << endl; return 1; }
+    } else {
+        int V = 6;
 
-    for(int src=0; src<V; src++) {
-        vector<int> parent;
-        vector<double> dist = dijkstra(g, src, parent);
-        save_shortest_paths(src, dist, parent, "shortest_paths.txt");
+        // Random weighted edges
+        vector<csr::Edge> edges;
+        for(int i=0;i<V;i++)
+            for(int j=i+1;j<V;j++)
+                if(rand()%2)
+                    edges.push_back({i,j, double(1+rand()%10)});
+        g = Graph::build(V, edges);
+    }
+    int V = g.num_vertices();
+
+    if(!ch_build.empty()) {
+        auto start = chrono::steady_clock::now();
+        ContractionHierarchy ch = ContractionHierarchy::build(g);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        try { ch.save(ch_build); }
+        catch(const exception &e) { cerr << e.what() << endl; return 1; }
+        cout << "Contraction hierarchy: " << V << " vertices, " << ch.num_shortcuts() << " shortcuts, built in "
+             << sec << " sec, saved to " << ch_build << endl;
+        return run_ch_queries(ch, queries);
+    }
+
+    if(!queries.empty()) {
+        P2PQuery query(g);
+        for(auto [s,t] : queries) {
+            if(s < 0 || s >= V || t < 0 || t >= V) {
+                cerr << "--query: vertices must be in [0, " << V << ")" << endl;
+                return 1;
+            }
+            print_path(s, t, query.bidirectional(s, t));
+        }
+        return 0;
+    }
+
+    // Scan the weights once, not per source
+    if(queue_kind == AUTO_QUEUE) queue_kind = choose_queue(g);
+    if((queue_kind == DIAL_BUCKETS || queue_kind == RADIX_HEAP) && max_integer_weight(g) < 0) {
+        cerr << "--queue " << queue << " needs non-negative integer weights below 2^32" << endl;
+        return 1;
     }
+    double hop_weight = algo == "bfs" ? uniform_weight(g) : 0;
+    if(hop_weight < 0) {
+        cerr << "--algo bfs needs all edges to have the same non-negative weight" << endl;
+        return 1;
+    }
+    vector<int> sources;
+    if(!parse_sources(sources_spec, V, sources)) {
+        cerr << "--sources: expected \"all\" or vertex ids in [0, " << V << ") separated by commas" << endl;
+        return 1;
+    }
+
+    // Only the generated demo graph is written out, for visualize.py; a
+    // loaded graph is already on disk
+    if(file.empty()) save_graph(g, "edges.txt");
+
+    try {
+        PathWriter out(out_file, binary, V, sources.size());
+        if(algo == "delta") run_delta_stepping(g, sources, delta, binary, out);
+        else if(algo == "bfs") run_bfs(g, sources, hop_weight, binary, out);
+        else run_dijkstra(g, sources, queue_kind, binary, out);
+        out.close();
+    } catch(const exception &e) { cerr << e.what() << endl; return 1; }
 
-    cout << "Graph and shortest paths saved in current directory" << endl;
+    if(file.empty()) cout << "Graph and shortest paths saved in current directory" << endl;
+    else cout << "Shortest paths saved to " << out_file << endl;
     return 0;
 }
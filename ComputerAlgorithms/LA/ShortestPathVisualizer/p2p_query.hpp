@@ -0,0 +1,181 @@
+#ifndef P2P_QUERY_HPP
+#define P2P_QUERY_HPP
+
+// Point-to-point shortest paths: bidirectional Dijkstra and A*.
+//
+// Unlike dijkstra() in graph_analysis.cpp these stop as soon as the s-t
+// distance is known and return the path itself. A P2PQuery owns all scratch
+// space (distances, parents and a 4-ary heap per direction); labels are
+// invalidated by bumping a query stamp, so a query costs only the vertices it
+// touches, not O(V). Use one P2PQuery per thread.
+//
+// bidirectional() grows a search from s and one from t (over reversed arcs),
+// always the side with fewer queued vertices, and stops once the two queue
+// minima add up to at least the best s-t path seen where the searches met.
+//
+// astar() searches from s with keys dist + h(v, t). h must be admissible
+// (never more than the true distance to t); vertices are re-opened when
+// their distance improves, so it need not be consistent.
+//
+//     P2PQuery q(g);
+//     PathResult r = q.bidirectional(s, t);            // r.dist, r.path = {s, ..., t}
+//     PathResult r = q.astar(s, t, EuclideanHeuristic(x, y));
+//
+// Weights must be non-negative.
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "../csr_graph.hpp"
+#include "../dary_heap.hpp"
+
+struct PathResult {
+    double dist = 1e9;     // 1e9 if t is unreachable, as in dijkstra()
+    std::vector<int> path; // s, ..., t; empty if unreachable
+    int settled = 0;       // vertices taken off the queues
+};
+
+// Plain Dijkstra that stops at t
+struct ZeroHeuristic {
+    double operator()(int, int) const { return 0; }
+};
+
+// Straight-line distance between vertex coordinates times scale. Admissible
+// when no arc is shorter than scale times the distance between its ends
+// (e.g. road lengths vs. coordinates, or scale = min speed for travel times).
+struct EuclideanHeuristic {
+    const std::vector<double>& x;
+    const std::vector<double>& y;
+    double scale;
+    EuclideanHeuristic(const std::vector<double>& x, const std::vector<double>& y, double scale = 1.0)
+        : x(x), y(y), scale(scale) {}
+    double operator()(int v, int t) const { return scale * std::hypot(x[v] - x[t], y[v] - y[t]); }
+};
+
+class P2PQuery {
+public:
+    static constexpr double INF = 1e9;
+
+    // backward holds the reversed arcs of forward; undirected graphs (what
+    // csr::load_graph builds by default) are their own reverse
+    explicit P2PQuery(const csr::Graph& forward, const csr::Graph* backward = nullptr)
+        : fwd(forward), bwd(backward ? *backward : forward) {
+        int V = fwd.num_vertices();
+        for (Side& side : sides) {
+            side.dist.resize(V);
+            side.parent.resize(V);
+            side.stamp.assign(V, 0);
+            side.heap.reset(V);
+        }
+    }
+
+    PathResult bidirectional(int s, int t) {
+        PathResult r;
+        if (!start(s, t)) return r;
+        Side& F = sides[0];
+        Side& B = sides[1];
+        label(F, s, 0, -1);
+        label(B, t, 0, -1);
+        F.heap.push(s, 0);
+        B.heap.push(t, 0);
+        double best = s == t ? 0 : INF;
+        int meet = s == t ? s : -1;
+
+        while (!F.heap.empty() && !B.heap.empty()) {
+            if (F.heap.top_key() + B.heap.top_key() >= best) break;
+            bool forward = F.heap.size() <= B.heap.size();
+            Side& S = forward ? F : B;
+            Side& O = forward ? B : F;
+            const csr::Graph& g = forward ? fwd : bwd;
+
+            double du = S.heap.top_key();
+            int u = S.heap.pop();
+            r.settled++;
+            for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+                int v = g.target(a);
+                double nd = du + g.weight(a);
+                if (nd >= dist(S, v)) continue;
+                label(S, v, nd, u);
+                S.heap.push_or_decrease(v, nd);
+                double through = nd + dist(O, v);
+                if (through < best) {
+                    best = through;
+                    meet = v;
+                }
+            }
+        }
+        if (meet < 0) return r;
+
+        r.dist = best;
+        for (int v = meet; v != -1; v = F.parent[v]) r.path.push_back(v);
+        std::reverse(r.path.begin(), r.path.end());
+        for (int v = B.parent[meet]; v != -1; v = B.parent[v]) r.path.push_back(v);
+        return r;
+    }
+
+    template <class Heuristic>
+    PathResult astar(int s, int t, Heuristic h) {
+        PathResult r;
+        if (!start(s, t)) return r;
+        Side& F = sides[0];
+        label(F, s, 0, -1);
+        F.heap.push(s, h(s, t));
+
+        while (!F.heap.empty()) {
+            int u = F.heap.pop();
+            r.settled++;
+            if (u == t) break;
+            double du = F.dist[u];
+            for (uint32_t a = fwd.arc_begin(u); a < fwd.arc_end(u); a++) {
+                int v = fwd.target(a);
+                double nd = du + fwd.weight(a);
+                if (nd >= dist(F, v)) continue;
+                label(F, v, nd, u);
+                F.heap.push_or_decrease(v, nd + h(v, t));
+            }
+        }
+        if (dist(F, t) >= INF) return r;
+
+        r.dist = F.dist[t];
+        for (int v = t; v != -1; v = F.parent[v]) r.path.push_back(v);
+        std::reverse(r.path.begin(), r.path.end());
+        return r;
+    }
+
+private:
+    struct Side {
+        std::vector<double> dist;
+        std::vector<int> parent;
+        std::vector<uint32_t> stamp; // dist/parent are valid iff stamp == query
+        IndexedDaryHeap<double, 4> heap;
+    };
+
+    const csr::Graph& fwd;
+    const csr::Graph& bwd;
+    Side sides[2];
+    uint32_t query = 0;
+
+    // Invalidates the previous query's labels; false if s or t is no vertex
+    bool start(int s, int t) {
+        int V = fwd.num_vertices();
+        if (s < 0 || s >= V || t < 0 || t >= V) return false;
+        if (++query == 0) {
+            for (Side& side : sides) std::fill(side.stamp.begin(), side.stamp.end(), 0);
+            query = 1;
+        }
+        for (Side& side : sides) side.heap.clear();
+        return true;
+    }
+
+    double dist(const Side& side, int v) const { return side.stamp[v] == query ? side.dist[v] : INF; }
+
+    void label(Side& side, int v, double d, int parent) {
+        side.stamp[v] = query;
+        side.dist[v] = d;
+        side.parent[v] = parent;
+    }
+};
+
+#endif
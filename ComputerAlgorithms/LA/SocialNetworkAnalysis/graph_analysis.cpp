@@ -1,84 +1,293 @@
 #include <bits/stdc++.h>
+#include "../graph_io.hpp"
+#include "../components.hpp"
+#include "louvain.hpp"
+#include "triangles.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using namespace std;
 
 // ----------------- Graph structure -----------------
-struct Graph {
-    int V;
-    vector<vector<int>> adj;
-
-    Graph(int V) {
-        this->V = V;
-        adj.resize(V);
-    }
-
-    void add_edge(int u, int v) {
-        adj[u].push_back(v);
-        adj[v].push_back(u); // undirected graph
-    }
-};
+// Undirected, unweighted graph in CSR form (see csr_graph.hpp)
+using Graph = csr::Graph;
 
 // ----------------- Betweenness Centrality (Brandes) -----------------
+// One BFS and dependency pass per source. Sources are shared out over the
+// OpenMP threads; each thread reuses its own buffers (resetting only the
+// vertices the last BFS reached) and adds into its own bc array, and the
+// arrays are summed at the end. Path counts are doubles: they grow
+// exponentially with the distance and overflow any integer type.
+//
+// No predecessor lists: the dependency pass walks the BFS order backwards and
+// pulls from the neighbours one level deeper (d[w] == d[v]+1), whose
+// dependencies are final by then. All per-source state is a few flat arrays
+// allocated once per thread, so the source loop does not allocate.
 vector<double> betweenness_centrality(Graph &g) {
-    int V = g.V;
-    vector<double> bc(V, 0.0);
+    int V = g.num_vertices();
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    // Allocated up front: the team may be smaller than threads, and the sum
+    // below reads every slot
+    vector<vector<double>> partial(threads, vector<double>(V, 0.0));
 
-    for(int s=0; s<V; s++){
-        stack<int> S;
-        vector<vector<int>> P(V);
-        vector<int> sigma(V, 0);
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        vector<double> &bc = partial[t];
+        vector<int> order;               // BFS queue, read backwards as the stack
+        vector<double> sigma(V, 0);
+        vector<double> coeff(V, 0);      // (1 + delta[w]) / sigma[w]
         vector<int> d(V, -1);
+        order.reserve(V);
 
-        sigma[s] = 1;
-        d[s] = 0;
-        queue<int> Q;
-        Q.push(s);
-
-        while(!Q.empty()) {
-            int v = Q.front(); Q.pop();
-            S.push(v);
-            for(int w : g.adj[v]){
-                if(d[w]<0){
-                    Q.push(w);
-                    d[w] = d[v]+1;
-                }
-                if(d[w] == d[v]+1){
-                    sigma[w] += sigma[v];
-                    P[w].push_back(v);
+        #pragma omp for schedule(dynamic, 16)
+        for(int s=0; s<V; s++){
+            order.clear();
+            sigma[s] = 1;
+            d[s] = 0;
+            order.push_back(s);
+
+            for(size_t head=0; head<order.size(); head++) {
+                int v = order[head];
+                for(int w : g.neighbors(v)){
+                    if(d[w]<0){
+                        order.push_back(w);
+                        d[w] = d[v]+1;
+                    }
+                    if(d[w] == d[v]+1) sigma[w] += sigma[v];
                 }
             }
-        }
 
-        vector<double> delta(V,0);
-        while(!S.empty()){
-            int w = S.top(); S.pop();
-            for(int v : P[w]){
-                delta[v] += ((double)sigma[v]/sigma[w])*(1+delta[w]);
+            // delta[v] = sigma[v] * sum of coeff[w] over successors w
+            for(size_t i=order.size(); i-- > 0; ){
+                int v = order[i];
+                double sum = 0;
+                for(int w : g.neighbors(v))
+                    if(d[w] == d[v]+1) sum += coeff[w];
+                double delta = sigma[v]*sum;
+                coeff[v] = (1+delta)/sigma[v];
+                if(v != s) bc[v] += delta;
+            }
+
+            for(int v : order){
+                sigma[v] = 0;
+                d[v] = -1;
             }
-            if(w != s) bc[w] += delta[w];
         }
     }
+
+    vector<double> bc(V, 0.0);
+    #pragma omp parallel for schedule(static)
+    for(int v=0; v<V; v++)
+        for(auto &p : partial) bc[v] += p[v];
     return bc;
 }
 
-// ----------------- Simple Community Detection -----------------
-vector<int> community_detection(Graph &g) {
-    int V = g.V;
-    vector<int> community(V);
-    for(int i=0;i<V;i++) community[i] = i;
+// ----------------- Approximate Betweenness (path sampling) -----------------
+// Riondato & Kornaropoulos: draw r random pairs (s, t) and one uniformly
+// random shortest s-t path for each; every inner vertex of the path gets 1/r.
+// With r = (c/eps^2) (floor(log2(VD-2)) + 1 + ln(1/delta)), VD the vertex
+// diameter, every estimate is within eps of the normalized betweenness
+// bc / (V(V-1)) at once, with probability at least 1 - delta. Results are
+// scaled back to the units of betweenness_centrality().
+//
+// Samples are drawn in parallel, each from its own random stream, so the
+// result depends on the seed but not on the thread count. With top_k > 0
+// sampling runs in batches and stops once the top-k vertices have stayed the
+// same for a few batches; eps is then recomputed for the samples drawn.
+struct BetweennessEstimate {
+    vector<double> bc, lower, upper; // same scale as betweenness_centrality()
+    long long samples = 0;
+    double eps = 0;                  // bound half-width, normalized units
+    bool stopped_early = false;
+};
+
+// Small, fast generator so that each sample can have its own stream
+struct SplitMix64 {
+    uint64_t x;
+    uint64_t next() {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+};
+
+// Upper bound on the vertices of any shortest path: 2 * eccentricity + 1 of
+// one vertex per connected component
+int vertex_diameter_bound(Graph &g) {
+    int V = g.num_vertices(), bound = 1;
+    vector<int> d(V, -1), order;
+    for(int r=0; r<V; r++){
+        if(d[r] >= 0) continue;
+        order.assign(1, r);
+        d[r] = 0;
+        for(size_t head=0; head<order.size(); head++)
+            for(int w : g.neighbors(order[head]))
+                if(d[w] < 0){
+                    d[w] = d[order[head]]+1;
+                    order.push_back(w);
+                }
+        bound = max(bound, 2*d[order.back()]+1);
+    }
+    return bound;
+}
+
+const double RK_CONSTANT = 0.5;
+
+double rk_log_term(int vertex_diameter, double delta) {
+    double hops = vertex_diameter > 2 ? floor(log2(vertex_diameter-2)) + 1 : 1;
+    return hops + log(1/delta);
+}
+
+BetweennessEstimate approximate_betweenness(Graph &g, double eps, double delta, int top_k = 0, uint64_t seed = 1) {
+    int V = g.num_vertices();
+    BetweennessEstimate est;
+    est.bc.assign(V, 0);
+    est.lower.assign(V, 0);
+    est.upper.assign(V, 0);
+    if(V < 2) return est;
+
+    double log_term = rk_log_term(vertex_diameter_bound(g), delta);
+    long long target = (long long)ceil(RK_CONSTANT / (eps*eps) * log_term);
+    const int BATCHES = 16, STABLE_BATCHES = 3;
+    long long batch = top_k > 0 ? max(1LL, (target + BATCHES-1) / BATCHES) : target;
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    vector<vector<uint32_t>> hits(threads, vector<uint32_t>(V, 0));
+    vector<long long> total(V, 0);
+    vector<int> top, prev_top;
+    int stable = 0;
+
+    while(est.samples < target) {
+        long long first = est.samples, last = min(target, first + batch);
+
+        #pragma omp parallel num_threads(threads)
+        {
+            int t = 0;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+#endif
+            // Buffers live across batches only through the thread's hits
+            vector<uint32_t> &my_hits = hits[t];
+            vector<int> d(V, -1), order;
+            vector<double> sigma(V, 0);
+
+            #pragma omp for schedule(dynamic, 64)
+            for(long long i=first; i<last; i++){
+                SplitMix64 rng{seed ^ (0xD1B54A32D192ED03ULL * (uint64_t)(i+1))};
+                int s = rng.next() % V, tgt = rng.next() % (V-1);
+                if(tgt >= s) tgt++;
 
-    for(int u=0; u<V; u++){
-        for(int v : g.adj[u]){
-            if(rand()%2) community[v] = community[u]; // random merge
+                // BFS from s, stopping after the level before tgt's
+                order.assign(1, s);
+                d[s] = 0;
+                sigma[s] = 1;
+                for(size_t head=0; head<order.size(); head++){
+                    int v = order[head];
+                    if(d[tgt] >= 0 && d[v] >= d[tgt]) break;
+                    for(int w : g.neighbors(v)){
+                        if(d[w] < 0){
+                            d[w] = d[v]+1;
+                            order.push_back(w);
+                        }
+                        if(d[w] == d[v]+1) sigma[w] += sigma[v];
+                    }
+                }
+
+                // Walk back along a uniformly random shortest path
+                if(d[tgt] >= 0){
+                    int w = tgt;
+                    while(d[w] > 1){
+                        double pick = rng.uniform() * sigma[w];
+                        int next = -1;
+                        for(int v : g.neighbors(w)){
+                            if(d[v] != d[w]-1) continue;
+                            next = v;
+                            pick -= sigma[v];
+                            if(pick < 0) break;
+                        }
+                        w = next;
+                        my_hits[w]++;
+                    }
+                }
+
+                for(int v : order){
+                    d[v] = -1;
+                    sigma[v] = 0;
+                }
+            }
+        }
+        est.samples = last;
+
+        if(top_k <= 0 || est.samples >= target) break;
+        // Stop once the top-k vertices settle
+        #pragma omp parallel for schedule(static)
+        for(int v=0; v<V; v++){
+            long long sum = 0;
+            for(auto &h : hits) sum += h[v];
+            total[v] = sum;
         }
+        top.resize(V);
+        iota(top.begin(), top.end(), 0);
+        int k = min(top_k, V);
+        partial_sort(top.begin(), top.begin()+k, top.end(),
+                     [&](int a, int b){ return total[a] != total[b] ? total[a] > total[b] : a < b; });
+        top.resize(k);
+        sort(top.begin(), top.end());
+        stable = top == prev_top ? stable+1 : 0;
+        prev_top = top;
+        if(stable >= STABLE_BATCHES){
+            est.stopped_early = true;
+            break;
+        }
+    }
+
+    est.eps = sqrt(RK_CONSTANT * log_term / est.samples);
+    double scale = (double)V * (V-1);
+    #pragma omp parallel for schedule(static)
+    for(int v=0; v<V; v++){
+        long long sum = 0;
+        for(auto &h : hits) sum += h[v];
+        double b = (double)sum / est.samples;
+        est.bc[v] = b * scale;
+        est.lower[v] = max(0.0, b - est.eps) * scale;
+        est.upper[v] = min(1.0, b + est.eps) * scale;
     }
-    return community;
+    return est;
+}
+
+// ----------------- Community Detection -----------------
+// Multilevel modularity optimization (louvain.hpp), or the much cheaper
+// label propagation (components.hpp)
+vector<int> community_detection(Graph &g, bool label_prop = false) {
+    if(label_prop) {
+        vector<int> community = label_propagation(g);
+        int count = community.empty() ? 0 : *max_element(community.begin(), community.end()) + 1;
+        cout << "Communities: " << count << ", modularity " << modularity(g, community) << endl;
+        return community;
+    }
+    LouvainResult r = louvain(g);
+    cout << "Communities: " << r.communities << ", modularity " << r.modularity
+         << ", levels " << r.level_modularity.size() << endl;
+    return r.community;
 }
 
 // ----------------- Save graph and centrality -----------------
 void save_graph(Graph &g, vector<int> &community, string filename) {
     ofstream fout(filename);
-    for(int u=0; u<g.V; u++){
-        for(int v : g.adj[u]){
+    for(int u=0; u<g.num_vertices(); u++){
+        for(int v : g.neighbors(u)){
             if(u<v) 
                 fout << u << " " << v << " " << community[u] << "\n";
         }
@@ -92,26 +301,95 @@ void save_centrality(vector<double> &bc, string filename) {
     fout.close();
 }
 
+// "vertex estimate lower upper", bounds holding for all vertices at once
+void save_centrality_bounds(BetweennessEstimate &est, string filename) {
+    ofstream fout(filename);
+    for(size_t i=0;i<est.bc.size();i++)
+        fout << i << " " << est.bc[i] << " " << est.lower[i] << " " << est.upper[i] << "\n";
+    fout.close();
+}
+
+// "vertex triangles clustering_coefficient"
+void save_clustering(TriangleStats &t, string filename) {
+    ofstream fout(filename);
+    for(size_t i=0;i<t.triangles.size();i++)
+        fout << i << " " << t.triangles[i] << " " << t.clustering[i] << "\n";
+    fout.close();
+}
+
 // ----------------- Main -----------------
-int main() {
+void usage(const char* prog) {
+    cerr << "Usage: " << prog << " [--approx EPS [--delta D] [--top-k K] [--seed S]] [--communities louvain|lpa] [graph file]\n";
+    cerr << "--approx estimates betweenness from sampled shortest paths, within EPS (normalized)\n";
+    cerr << "         with probability 1-D (default 0.1); --top-k stops once the top K settle.\n";
+    cerr << "         Bounds go to output/centrality_bounds.txt\n";
+    cerr << "--communities picks Louvain (default) or label propagation\n";
+    cerr << "Triangle counts and clustering coefficients go to output/clustering.txt\n";
+}
+
+int main(int argc, char* argv[]) {
     srand(time(0));
+    string file;
+    double eps = 0, delta = 0.1;
+    int top_k = 0;
+    uint64_t seed = rand();
+    string communities = "louvain";
+    for(int i=1; i<argc; i++) {
+        string arg = argv[i];
+        if(arg == "--approx" && i+1 < argc) eps = atof(argv[++i]);
+        else if(arg == "--delta" && i+1 < argc) delta = atof(argv[++i]);
+        else if(arg == "--top-k" && i+1 < argc) top_k = atoi(argv[++i]);
+        else if(arg == "--seed" && i+1 < argc) seed = strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--communities" && i+1 < argc) communities = argv[++i];
+        else if(arg[0] != '-' && file.empty()) file = arg;
+        else { usage(argv[0]); return 1; }
+    }
+    if(eps < 0 || eps >= 1 || delta <= 0 || delta >= 1) { usage(argv[0]); return 1; }
+    if(communities != "louvain" && communities != "lpa") { usage(argv[0]); return 1; }
 
-    int V = 10; // number of nodes
-    Graph g(V);
+    Graph g;
+    if(!file.empty()) {
+        // Text edge list or binary CSR file (see graph_io.hpp); weights are ignored
+        try { g = csr::load_graph(file); }
+        catch(const exception &e) { cerr << e.what() << endl; return 1; }
+    } else {
+        int V = 10; // number of nodes
 
-    // Random edges
-    for(int i=0;i<V;i++){
-        for(int j=i+1;j<V;j++){
-            if(rand()%2) g.add_edge(i,j);
+        // Random edges
+        vector<csr::Edge> edges;
+        for(int i=0;i<V;i++){
+            for(int j=i+1;j<V;j++){
+                if(rand()%2) edges.push_back({i,j,1.0});
+            }
         }
+        g = Graph::build(V, edges, true, false);
     }
 
+    Components cc = Components::of(g);
+    if(cc.count > 1)
+        cout << "Components: " << cc.count << ", largest has " << cc.size(cc.largest())
+             << " of " << g.num_vertices() << " vertices" << endl;
+
     // Compute centrality
-    vector<double> bc = betweenness_centrality(g);
-    save_centrality(bc, "output/centrality.txt");
+    if(eps > 0) {
+        BetweennessEstimate est = approximate_betweenness(g, eps, delta, top_k, seed);
+        save_centrality(est.bc, "output/centrality.txt");
+        save_centrality_bounds(est, "output/centrality_bounds.txt");
+        cout << "Sampled " << est.samples << " paths" << (est.stopped_early ? " (top-k settled early)" : "")
+             << ", bounds +-" << est.eps << " normalized" << endl;
+    } else {
+        vector<double> bc = betweenness_centrality(g);
+        save_centrality(bc, "output/centrality.txt");
+    }
+
+    // Triangles and clustering
+    TriangleStats tri = count_triangles(g);
+    save_clustering(tri, "output/clustering.txt");
+    cout << "Triangles: " << tri.total << ", transitivity " << tri.transitivity
+         << ", average clustering " << tri.average_clustering << endl;
 
     // Detect communities
-    vector<int> comm = community_detection(g);
+    vector<int> comm = community_detection(g, communities == "lpa");
     save_graph(g, comm, "output/graph.txt");
 
     cout << "Computation done. Files saved in output/" << endl;
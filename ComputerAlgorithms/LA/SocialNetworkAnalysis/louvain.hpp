@@ -0,0 +1,366 @@
+#ifndef LOUVAIN_HPP
+#define LOUVAIN_HPP
+
+// Multilevel Louvain community detection (Blondel et al.) on undirected CSR
+// graphs; unweighted graphs count every edge as weight 1.
+//
+// Each level alternates two phases:
+//   local moving  every vertex moves to the neighbouring community with the
+//                 best modularity gain, sweeping until a sweep raises the
+//                 modularity by less than `tolerance`;
+//   coarsening    every community becomes one vertex of the next level; the
+//                 arcs between two communities merge into one whose weight is
+//                 their sum, the arcs inside a community into a self loop.
+// Levels repeat until local moving changes nothing.
+//
+// Local moving runs in parallel. Vertices are split into a fixed set of
+// pseudo-random classes that are processed one after another; the vertices of
+// a class pick their moves against the same snapshot, and the moves are
+// applied after the whole class is done. The outcome therefore does not depend
+// on the thread count or schedule (exactly so for integer weights, whose sums
+// are exact). Two singletons moving into each other at the same time would
+// just swap, so a singleton only joins another singleton with a smaller id.
+// Other simultaneous moves can still undo each other, so each sweep measures
+// the modularity it reached and is rolled back if that is no better.
+// Each thread sums the weights towards the neighbouring communities in its own
+// small open-addressing table, cleared in O(entries used).
+//
+//     LouvainResult r = louvain(g);
+//     r.community[v];                 // dense ids 0..r.communities-1
+//     r.modularity;                   // of r.community on g
+//
+// Modularity counts arcs: Q = 1/2m sum_c (in_c - resolution * tot_c^2 / 2m),
+// with 2m the total arc weight, in_c the weight of the arcs inside c and tot_c
+// the total degree of c.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../csr_graph.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct LouvainResult {
+    std::vector<int> community;           // of each vertex, dense from 0
+    int communities = 0;
+    double modularity = 0;
+    std::vector<double> level_modularity; // after each level
+};
+
+// Weight of the arcs from one vertex (or community) to each neighbouring
+// community. Linear probing; only the slots used are cleared by reset().
+class CommunityWeights {
+public:
+    // Ready for up to n distinct keys
+    void reset(size_t n) {
+        for (uint32_t i : used) keys[i] = -1;
+        used.clear();
+        size_t cap = 16;
+        while (cap < 2 * n) cap *= 2;
+        if (cap > keys.size()) {
+            keys.assign(cap, -1);
+            vals.resize(cap);
+        }
+        mask = cap - 1;
+    }
+
+    void add(int key, double w) {
+        uint32_t i = ((uint32_t)key * 0x9E3779B1u) & mask;
+        while (keys[i] != key) {
+            if (keys[i] < 0) {
+                keys[i] = key;
+                vals[i] = 0;
+                used.push_back(i);
+                break;
+            }
+            i = (i + 1) & mask;
+        }
+        vals[i] += w;
+    }
+
+    double get(int key) const {
+        uint32_t i = ((uint32_t)key * 0x9E3779B1u) & mask;
+        while (keys[i] >= 0) {
+            if (keys[i] == key) return vals[i];
+            i = (i + 1) & mask;
+        }
+        return 0;
+    }
+
+    size_t size() const { return used.size(); }
+    int key(size_t j) const { return keys[used[j]]; }
+    double value(size_t j) const { return vals[used[j]]; }
+
+private:
+    std::vector<int> keys; // -1 = empty
+    std::vector<double> vals;
+    std::vector<uint32_t> used;
+    uint32_t mask = 0;
+};
+
+// Modularity of a partition (community ids in [0, V))
+inline double modularity(const csr::Graph& g, const std::vector<int>& community, double resolution = 1.0) {
+    int V = g.num_vertices();
+    std::vector<double> tot(V, 0);
+    double inside = 0, m2 = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : inside, m2)
+    for (int u = 0; u < V; u++) {
+        double k = 0;
+        for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            k += g.weight(a);
+            if (community[g.target(a)] == community[u]) inside += g.weight(a);
+        }
+        m2 += k;
+        #pragma omp atomic
+        tot[community[u]] += k;
+    }
+    if (m2 == 0) return 0;
+    double spread = 0;
+    #pragma omp parallel for reduction(+ : spread)
+    for (int c = 0; c < V; c++) spread += tot[c] * tot[c];
+    return inside / m2 - resolution * spread / (m2 * m2);
+}
+
+class Louvain {
+public:
+    static LouvainResult run(const csr::Graph& g, double resolution = 1.0, double tolerance = 1e-6) {
+        LouvainResult r;
+        int V = g.num_vertices();
+        r.community.resize(V);
+        for (int v = 0; v < V; v++) r.community[v] = v;
+        r.communities = V;
+
+        csr::Graph level = g;
+        const int MAX_LEVELS = 64;
+        for (int depth = 0; depth < MAX_LEVELS; depth++) {
+            std::vector<int> comm;
+            if (!move_vertices(level, resolution, tolerance, comm)) break;
+            int count = renumber(comm);
+            #pragma omp parallel for schedule(static)
+            for (int v = 0; v < V; v++) r.community[v] = comm[r.community[v]];
+            r.communities = count;
+            r.level_modularity.push_back(modularity(level, comm, resolution));
+            level = coarsen(level, comm, count);
+        }
+        r.modularity = modularity(g, r.community, resolution);
+        return r;
+    }
+
+private:
+    static constexpr int CLASSES = 8;
+    static constexpr int MAX_SWEEPS = 100;
+
+    static int thread_id() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    static int max_threads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    // Class of a vertex in local moving; a hash so that neighbouring ids are
+    // spread over the classes
+    static int class_of(int v) { return ((uint32_t)v * 0x9E3779B1u) >> 29; }
+
+    // Local moving on one level; comm receives the community of each vertex.
+    // Returns false if no sweep raised the modularity.
+    static bool move_vertices(const csr::Graph& g, double resolution, double tolerance, std::vector<int>& comm) {
+        int V = g.num_vertices();
+        std::vector<double> k(V), tot(V);
+        std::vector<int> size(V, 1), target(V);
+        comm.resize(V);
+        double m2 = 0;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : m2)
+        for (int u = 0; u < V; u++) {
+            double sum = 0;
+            for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) sum += g.weight(a);
+            k[u] = tot[u] = sum;
+            comm[u] = u;
+            m2 += sum;
+        }
+        if (m2 == 0) return false;
+
+        // Vertices grouped by class
+        std::vector<int> order(V), class_begin(CLASSES + 1, 0);
+        for (int v = 0; v < V; v++) class_begin[class_of(v) + 1]++;
+        for (int c = 0; c < CLASSES; c++) class_begin[c + 1] += class_begin[c];
+        std::vector<int> cursor(class_begin.begin(), class_begin.end() - 1);
+        for (int v = 0; v < V; v++) order[cursor[class_of(v)]++] = v;
+
+        std::vector<CommunityWeights> tables(max_threads());
+        std::vector<int> saved;
+        double q = quality(g, comm, tot, m2, resolution);
+        bool improved = false;
+        for (int sweep = 0; sweep < MAX_SWEEPS; sweep++) {
+            saved = comm;
+            for (int c = 0; c < CLASSES; c++) {
+                #pragma omp parallel for schedule(dynamic, 256)
+                for (int i = class_begin[c]; i < class_begin[c + 1]; i++) {
+                    int u = order[i];
+                    target[u] = best_move(g, u, comm, k, tot, size, m2, resolution, tables[thread_id()]);
+                }
+                // Apply the class's moves together
+                #pragma omp parallel for schedule(static)
+                for (int i = class_begin[c]; i < class_begin[c + 1]; i++) {
+                    int u = order[i], from = comm[u], to = target[u];
+                    if (to == from) continue;
+                    #pragma omp atomic
+                    tot[from] -= k[u];
+                    #pragma omp atomic
+                    tot[to] += k[u];
+                    #pragma omp atomic
+                    size[from]--;
+                    #pragma omp atomic
+                    size[to]++;
+                    comm[u] = to;
+                }
+            }
+            double next = quality(g, comm, tot, m2, resolution);
+            if (next <= q) {
+                comm.swap(saved); // tot and size are not needed any more
+                break;
+            }
+            improved = true;
+            bool done = next - q < tolerance;
+            q = next;
+            if (done) break;
+        }
+        return improved;
+    }
+
+    // Modularity of comm given the community degrees tot
+    static double quality(const csr::Graph& g, const std::vector<int>& comm, const std::vector<double>& tot,
+                          double m2, double resolution) {
+        int V = g.num_vertices();
+        double inside = 0, spread = 0;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : inside, spread)
+        for (int u = 0; u < V; u++) {
+            for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++)
+                if (comm[g.target(a)] == comm[u]) inside += g.weight(a);
+            spread += tot[u] * tot[u];
+        }
+        return inside / m2 - resolution * spread / (m2 * m2);
+    }
+
+    // Best community for u against the current snapshot
+    static int best_move(const csr::Graph& g, int u, const std::vector<int>& comm, const std::vector<double>& k,
+                         const std::vector<double>& tot, const std::vector<int>& size, double m2,
+                         double resolution, CommunityWeights& table) {
+        int own = comm[u];
+        table.reset(g.degree(u));
+        for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            int v = g.target(a);
+            if (v != u) table.add(comm[v], g.weight(a));
+        }
+
+        // Gain of joining c, up to a term shared by all c:
+        // w(u, c) - resolution * k_u * tot_c / 2m, with u taken out of its own
+        double scale = resolution * k[u] / m2;
+        double stay = table.get(own) - scale * (tot[own] - k[u]);
+        int best = own;
+        double best_score = stay;
+        bool alone = size[own] == 1;
+        for (size_t j = 0; j < table.size(); j++) {
+            int c = table.key(j);
+            if (c == own) continue;
+            if (alone && size[c] == 1 && c > own) continue;
+            double score = table.value(j) - scale * tot[c];
+            if (score > best_score || (score == best_score && best != own && c < best)) {
+                best = c;
+                best_score = score;
+            }
+        }
+        return best;
+    }
+
+    // Renumbers the community ids densely in order of first id; returns the count
+    static int renumber(std::vector<int>& comm) {
+        int V = comm.size();
+        std::vector<int> id(V, 0);
+        #pragma omp parallel for schedule(static)
+        for (int v = 0; v < V; v++) id[comm[v]] = 1;
+        int count = 0;
+        for (int c = 0; c < V; c++) id[c] = id[c] ? count++ : -1;
+        #pragma omp parallel for schedule(static)
+        for (int v = 0; v < V; v++) comm[v] = id[comm[v]];
+        return count;
+    }
+
+    struct Storage {
+        std::vector<uint32_t> offsets;
+        std::vector<int> targets;
+        std::vector<double> weights;
+    };
+
+    // One vertex per community; arcs between communities merged by summing
+    static csr::Graph coarsen(const csr::Graph& g, const std::vector<int>& comm, int count) {
+        int V = g.num_vertices();
+        std::vector<int> member_begin(count + 1, 0), members(V);
+        for (int v = 0; v < V; v++) member_begin[comm[v] + 1]++;
+        for (int c = 0; c < count; c++) member_begin[c + 1] += member_begin[c];
+        std::vector<int> cursor(member_begin.begin(), member_begin.end() - 1);
+        for (int v = 0; v < V; v++) members[cursor[comm[v]]++] = v;
+
+        auto s = std::make_shared<Storage>();
+        s->offsets.assign((size_t)count + 1, 0);
+        std::vector<CommunityWeights> tables(max_threads());
+        auto gather = [&](int c, CommunityWeights& table) {
+            size_t arcs = 0;
+            for (int i = member_begin[c]; i < member_begin[c + 1]; i++) arcs += g.degree(members[i]);
+            table.reset(arcs);
+            for (int i = member_begin[c]; i < member_begin[c + 1]; i++) {
+                int u = members[i];
+                for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) table.add(comm[g.target(a)], g.weight(a));
+            }
+        };
+
+        // Count the merged arcs, then fill them in
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int c = 0; c < count; c++) {
+            CommunityWeights& table = tables[thread_id()];
+            gather(c, table);
+            s->offsets[c + 1] = table.size();
+        }
+        csr::parallel_prefix_sum(s->offsets);
+        s->targets.resize(s->offsets[count]);
+        s->weights.resize(s->offsets[count]);
+
+        #pragma omp parallel
+        {
+            CommunityWeights& table = tables[thread_id()];
+            std::vector<std::pair<int, double>> arcs;
+            #pragma omp for schedule(dynamic, 256)
+            for (int c = 0; c < count; c++) {
+                gather(c, table);
+                arcs.clear();
+                for (size_t j = 0; j < table.size(); j++) arcs.push_back({table.key(j), table.value(j)});
+                std::sort(arcs.begin(), arcs.end());
+                uint32_t slot = s->offsets[c];
+                for (auto& [v, w] : arcs) {
+                    s->targets[slot] = v;
+                    s->weights[slot++] = w;
+                }
+            }
+        }
+        return csr::Graph::view(count, s->offsets[count], s->offsets.data(), s->targets.data(), s->weights.data(), s);
+    }
+};
+
+inline LouvainResult louvain(const csr::Graph& g, double resolution = 1.0, double tolerance = 1e-6) {
+    return Louvain::run(g, resolution, tolerance);
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef TRIANGLES_HPP
+#define TRIANGLES_HPP
+
+// Triangle counting, local clustering coefficients and transitivity for
+// undirected CSR graphs. Self loops and repeated edges are ignored.
+//
+// Every edge is oriented from the lower to the higher rank, ranking vertices
+// by (degree, id). Each triangle is then found exactly once, from its lowest
+// vertex u, as the common out-neighbours of u and each out-neighbour v, and
+// no out-list is longer than sqrt(2m), which bounds the work by O(m^1.5)
+// however skewed the degrees are. Vertices are shared out over the OpenMP
+// threads; the per-vertex counts are bumped with atomic adds.
+//
+// Out-lists stay sorted by id, so each intersection is a merge. Lists of
+// similar length are merged 8 x 8 ids at a time with AVX2 (all-pairs compare
+// of two blocks through lane rotations), or with a scalar merge where AVX2 is
+// missing; the ISA is picked at runtime as in sort_network.hpp. When one list
+// is much longer, every id of the short one is galloped for in the long one.
+//
+//     TriangleStats t = count_triangles(g);
+//     t.triangles[v];       // triangles through v
+//     t.clustering[v];      // triangles[v] / (d(d-1)/2), 0 if d < 2
+//     t.transitivity;       // 3 * total / connected triples
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../csr_graph.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TRIANGLES_X86 1
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct TriangleStats {
+    std::vector<uint64_t> triangles; // through each vertex
+    std::vector<double> clustering;  // local clustering coefficient
+    uint64_t total = 0;
+    double transitivity = 0;         // global: 3 * total / connected triples
+    double average_clustering = 0;   // mean of clustering over all vertices
+};
+
+namespace triangles {
+
+// Lists more than this many times longer than the other are galloped
+const size_t GALLOP_RATIO = 32;
+
+inline bool detect_avx2() {
+#ifdef TRIANGLES_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// Detected once; callers may clear it (e.g. to compare against the scalar path)
+inline bool& use_avx2() {
+    static bool avx2 = detect_avx2();
+    return avx2;
+}
+
+// Each intersect_* writes the common ids of the sorted, duplicate-free lists
+// a and b to out and returns how many there are
+
+inline size_t intersect_scalar(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, n = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) i++;
+        else if (b[j] < a[i]) j++;
+        else {
+            out[n++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return n;
+}
+
+// a is the short list
+inline size_t intersect_gallop(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t n = 0, lo = 0;
+    for (size_t i = 0; i < na && lo < nb; i++) {
+        // Double the step until past a[i], then binary search the last step
+        size_t step = 1, hi = lo;
+        while (hi < nb && b[hi] < a[i]) {
+            lo = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        lo = std::lower_bound(b + lo, b + std::min(hi, nb), a[i]) - b;
+        if (lo < nb && b[lo] == a[i]) out[n++] = b[lo++];
+    }
+    return n;
+}
+
+#ifdef TRIANGLES_X86
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+inline size_t intersect_avx2(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, n = 0;
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + j));
+        // Lane k of va against every lane of vb
+        __m256i hit = _mm256_cmpeq_epi32(va, vb);
+        for (int r = 1; r < 8; r++) {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(va, vb));
+        }
+        for (unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(hit)); mask; mask &= mask - 1)
+            out[n++] = a[i + __builtin_ctz(mask)];
+        // Drop the block(s) whose largest id is smaller or equal
+        int a_last = a[i + 7], b_last = b[j + 7];
+        if (a_last <= b_last) i += 8;
+        if (b_last <= a_last) j += 8;
+    }
+    return n + intersect_scalar(a + i, na - i, b + j, nb - j, out + n);
+}
+
+#pragma GCC pop_options
+#endif
+
+inline size_t intersect(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na == 0) return 0;
+    if (nb > GALLOP_RATIO * na) return intersect_gallop(a, na, b, nb, out);
+#ifdef TRIANGLES_X86
+    if (use_avx2()) return intersect_avx2(a, na, b, nb, out);
+#endif
+    return intersect_scalar(a, na, b, nb, out);
+}
+
+} // namespace triangles
+
+inline TriangleStats count_triangles(const csr::Graph& g) {
+    int V = g.num_vertices();
+    TriangleStats st;
+    st.triangles.assign(V, 0);
+    st.clustering.assign(V, 0);
+
+    // Distinct neighbours other than the vertex itself (lists are sorted)
+    std::vector<uint32_t> degree(V);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int u = 0; u < V; u++) {
+        uint32_t d = 0;
+        for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            int v = g.target(a);
+            if (v != u && (a == g.arc_begin(u) || g.target(a - 1) != v)) d++;
+        }
+        degree[u] = d;
+    }
+    auto before = [&](int u, int v) { return degree[u] != degree[v] ? degree[u] < degree[v] : u < v; };
+
+    // Oriented graph: out-lists hold the distinct higher-ranked neighbours
+    std::vector<uint32_t> offsets((size_t)V + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int u = 0; u < V; u++) {
+        uint32_t d = 0;
+        for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            int v = g.target(a);
+            if (before(u, v) && (a == g.arc_begin(u) || g.target(a - 1) != v)) d++;
+        }
+        offsets[u + 1] = d;
+    }
+    csr::parallel_prefix_sum(offsets);
+    std::vector<int> out(offsets[V]);
+    uint32_t max_out = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(max : max_out)
+    for (int u = 0; u < V; u++) {
+        uint32_t slot = offsets[u];
+        for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            int v = g.target(a);
+            if (before(u, v) && (a == g.arc_begin(u) || g.target(a - 1) != v)) out[slot++] = v;
+        }
+        max_out = std::max(max_out, offsets[u + 1] - offsets[u]);
+    }
+
+    uint64_t total = 0;
+    #pragma omp parallel reduction(+ : total)
+    {
+        std::vector<int> common(max_out);
+        #pragma omp for schedule(dynamic, 64)
+        for (int u = 0; u < V; u++) {
+            const int* nu = out.data() + offsets[u];
+            size_t du = offsets[u + 1] - offsets[u];
+            uint64_t at_u = 0;
+            for (size_t i = 0; i < du; i++) {
+                int v = nu[i];
+                size_t n = triangles::intersect(nu, du, out.data() + offsets[v], offsets[v + 1] - offsets[v],
+                                                common.data());
+                if (n == 0) continue;
+                at_u += n;
+                __atomic_fetch_add(&st.triangles[v], n, __ATOMIC_RELAXED);
+                for (size_t k = 0; k < n; k++) __atomic_fetch_add(&st.triangles[common[k]], 1, __ATOMIC_RELAXED);
+            }
+            if (at_u) __atomic_fetch_add(&st.triangles[u], at_u, __ATOMIC_RELAXED);
+            total += at_u;
+        }
+    }
+    st.total = total;
+
+    double triples = 0, sum_clustering = 0;
+    #pragma omp parallel for schedule(static) reduction(+ : triples, sum_clustering)
+    for (int u = 0; u < V; u++) {
+        double pairs = (double)degree[u] * (degree[u] - 1) / 2;
+        triples += pairs;
+        if (pairs > 0) st.clustering[u] = st.triangles[u] / pairs;
+        sum_clustering += st.clustering[u];
+    }
+    st.transitivity = triples > 0 ? 3.0 * total / triples : 0;
+    st.average_clustering = V > 0 ? sum_clustering / V : 0;
+    return st;
+}
+
+#endif
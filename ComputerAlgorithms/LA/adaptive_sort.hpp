@@ -0,0 +1,214 @@
+#ifndef ADAPTIVE_SORT_HPP
+#define ADAPTIVE_SORT_HPP
+
+// Run-adaptive merge sort for inputs that arrive (nearly) ordered.
+//
+// Natural runs are detected left to right: non-decreasing runs are kept,
+// strictly decreasing runs are reversed in place (so equal keys are never
+// swapped past each other by the reversal).
+// Runs shorter than MIN_RUN are extended and sorted with the sortlib engine.
+// Runs are merged in powersort order (Munro & Wild 2018), with galloping
+// merges that skip over blocks already in place. Sorted and reversed inputs
+// cost n-1 comparisons; k runs cost O(n log k).
+//
+// If the run scan finds mostly short runs the input is not presorted, and
+// the whole range goes straight to the quicksort engine. Its depth limit
+// keeps adversarial inputs (sort_bench's killer distribution) at O(n log n).
+//
+//     sortlib::adaptiveSort(v.begin(), v.end());
+//     sortlib::CountingStats stats;
+//     sortlib::adaptiveSort(v.begin(), v.end(), std::less<int>(), stats);
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "sortlib.hpp"
+
+namespace sortlib {
+
+namespace adaptive {
+
+const int MIN_RUN = 32;
+const int MIN_GALLOP = 7;
+
+// First element of [first, last) that is greater than key, searching
+// exponentially from the left end
+template <class It, class T, class Cmp>
+It gallopUpper(It first, It last, const T& key, Cmp& cmp) {
+    auto n = last - first;
+    decltype(n) lo = 0, step = 1;
+    while (step <= n && !cmp(key, first[step - 1])) {
+        lo = step;
+        step *= 2;
+    }
+    return std::upper_bound(first + lo, first + std::min(step, n), key, cmp);
+}
+
+// First element of [first, last) that is not less than key, from the left
+template <class It, class T, class Cmp>
+It gallopLower(It first, It last, const T& key, Cmp& cmp) {
+    auto n = last - first;
+    decltype(n) lo = 0, step = 1;
+    while (step <= n && cmp(first[step - 1], key)) {
+        lo = step;
+        step *= 2;
+    }
+    return std::lower_bound(first + lo, first + std::min(step, n), key, cmp);
+}
+
+// Same as gallopLower but searching from the right end
+template <class It, class T, class Cmp>
+It gallopLowerFromEnd(It first, It last, const T& key, Cmp& cmp) {
+    auto n = last - first;
+    decltype(n) hi = n, step = 1;
+    while (step <= n && !cmp(last[-step], key)) {
+        hi = n - step;
+        step *= 2;
+    }
+    return std::lower_bound(first + (step > n ? 0 : n - step), first + hi, key, cmp);
+}
+
+// Stable merge of sorted [first, mid) and [mid, last) through buf
+template <class It, class Cmp, class Buf>
+void gallopMerge(It first, It mid, It last, Cmp& cmp, Buf& buf) {
+    // Prefix of the left run and suffix of the right run are already in place
+    first = gallopUpper(first, mid, *mid, cmp);
+    if (first == mid) return;
+    last = gallopLowerFromEnd(mid, last, *(mid - 1), cmp);
+    if (mid == last) return;
+
+    buf.assign(std::make_move_iterator(first), std::make_move_iterator(mid));
+    auto a = buf.begin(), aEnd = buf.end();
+    It b = mid, out = first;
+    int winsA = 0, winsB = 0;
+    while (a != aEnd && b != last) {
+        if (winsA >= MIN_GALLOP) {
+            auto stop = gallopUpper(a, aEnd, *b, cmp);
+            out = std::move(a, stop, out);
+            a = stop;
+            winsA = 0;
+            if (a != aEnd) { *out++ = std::move(*b++); winsB = 1; }
+        } else if (winsB >= MIN_GALLOP) {
+            It stop = gallopLower(b, last, *a, cmp);
+            out = std::move(b, stop, out);
+            b = stop;
+            winsB = 0;
+            if (b != last) { *out++ = std::move(*a++); winsA = 1; }
+        } else if (cmp(*b, *a)) {
+            *out++ = std::move(*b++);
+            winsB++;
+            winsA = 0;
+        } else {
+            *out++ = std::move(*a++);
+            winsA++;
+            winsB = 0;
+        }
+    }
+    std::move(a, aEnd, out);
+}
+
+// Powersort node power of the boundary between runs [s1, s1+n1) and
+// [s1+n1, s1+n1+n2) in a range of n elements: the first bit where the
+// binary expansions of the two run midpoints (as fractions of n) differ.
+inline int nodePower(uint64_t s1, uint64_t n1, uint64_t n2, uint64_t n) {
+    uint64_t a = 2 * s1 + n1, b = 2 * (s1 + n1) + n2, N = 2 * n;
+    int power = 0;
+    while (true) {
+        power++;
+        a <<= 1;
+        b <<= 1;
+        bool da = a >= N, db = b >= N;
+        if (da != db) return power;
+        if (da) { a -= N; b -= N; }
+    }
+}
+
+// End of the natural run starting at first; descending runs are reversed
+template <class It, class Cmp>
+It findRun(It first, It last, Cmp& cmp) {
+    It end = first + 1;
+    if (end == last) return end;
+    if (cmp(*end, *first)) {
+        while (end + 1 != last && cmp(*(end + 1), *end)) ++end;
+        std::reverse(first, end + 1);
+    } else {
+        while (end + 1 != last && !cmp(*(end + 1), *end)) ++end;
+    }
+    return end + 1;
+}
+
+} // namespace adaptive
+
+template <class It, class Cmp, class Stats>
+void adaptiveSort(It first, It last, Cmp cmp, Stats& stats) {
+    using namespace adaptive;
+    using T = typename std::iterator_traits<It>::value_type;
+    auto n = last - first;
+    if (n < 2) return;
+    Counted<Cmp, Stats> less{cmp, stats};
+
+    // One scan: natural run boundaries (descending runs reversed on the way)
+    std::vector<It> ends;
+    for (It start = first; start != last; start = ends.back())
+        ends.push_back(findRun(start, last, less));
+
+    // Mostly short runs: not presorted, quicksort wins (three-way, so
+    // duplicate-heavy inputs stay fast too)
+    if (ends.size() * MIN_RUN > (size_t)n) {
+        quickSort(first, last, cmp, stats, Median3Pivot(), ThreeWayPartition(), InsertionBase<16>());
+        return;
+    }
+
+    // Run starting at `start`: the rest of the natural run it falls in, or
+    // MIN_RUN elements sorted by the engine if that is too short. A suffix of
+    // a natural run is still sorted, so runs may start mid-way through one.
+    size_t idx = 0;
+    auto nextRun = [&](It start) {
+        while (ends[idx] <= start) idx++;
+        It end = ends[idx];
+        if (end - start < MIN_RUN) {
+            end = start + std::min<decltype(n)>(MIN_RUN, last - start);
+            quickSort(start, end, cmp, stats, Median3Pivot(), ThreeWayPartition(), InsertionBase<MIN_RUN>());
+        }
+        return end;
+    };
+
+    struct Run { It start; It end; int power; };
+    std::vector<Run> stack;
+    std::vector<T> buf;
+    auto merge = [&](It s, It m, It e) {
+        stats.call();
+        gallopMerge(s, m, e, less, buf);
+    };
+
+    // Powersort: a boundary with a higher power than the next one is merged first
+    It aStart = first, aEnd = nextRun(first);
+    while (aEnd != last) {
+        It bEnd = nextRun(aEnd);
+        int p = nodePower(aStart - first, aEnd - aStart, bEnd - aEnd, n);
+        while (!stack.empty() && stack.back().power > p) {
+            merge(stack.back().start, stack.back().end, aEnd);
+            aStart = stack.back().start;
+            stack.pop_back();
+        }
+        stack.push_back({aStart, aEnd, p});
+        aStart = aEnd;
+        aEnd = bEnd;
+    }
+    while (!stack.empty()) {
+        merge(stack.back().start, stack.back().end, last);
+        stack.pop_back();
+    }
+}
+
+template <class It, class Cmp = std::less<>>
+void adaptiveSort(It first, It last, Cmp cmp = Cmp()) {
+    NoStats stats;
+    adaptiveSort(first, last, cmp, stats);
+}
+
+} // namespace sortlib
+
+#endif
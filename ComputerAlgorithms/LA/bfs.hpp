@@ -0,0 +1,226 @@
+#ifndef BFS_HPP
+#define BFS_HPP
+
+// Direction-optimizing breadth-first search (Beamer et al.) on CSR graphs.
+//
+// Top-down steps expand a frontier queue: every frontier vertex checks all its
+// arcs and claims the unvisited neighbours with compare-and-swap. Once the
+// arcs out of the frontier exceed 1/ALPHA of those not yet explored, the
+// search goes bottom-up: every unvisited vertex scans its own neighbours for
+// one in the frontier bitmap and stops at the first hit. On low-diameter
+// graphs the middle levels hold most of the vertices, and most of their arc
+// checks are skipped that way. The search goes back to top-down once the
+// frontier stops growing and holds fewer than V/BETA vertices.
+//
+// Both steps run on all OpenMP threads. Bottom-up hands out the vertices in
+// blocks of 64, one bitmap word each, so the next frontier is written without
+// atomics.
+//
+// Bottom-up follows arcs backwards. Undirected graphs (what csr::load_graph
+// builds by default) are their own reverse; directed ones need the reversed
+// graph passed in, as for P2PQuery.
+//
+//     BFS bfs(g);                        // one per concurrent search, reused
+//     const BFSResult& r = bfs.run(s);
+//     r.level[v];                        // hops from s, -1 if unreachable
+//     r.parent[v];                       // previous vertex, -1 for s and unreachable
+//
+// Levels are deterministic. With several threads, parent is any vertex one
+// level up and may differ between runs.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct BFSResult {
+    std::vector<int> level;
+    std::vector<int> parent;
+    int depth = 0;              // largest level
+    int reached = 0;            // vertices with a level, s included
+    long long arcs_checked = 0; // compare with num_arcs() to see what bottom-up skipped
+    int bottom_up_steps = 0;
+};
+
+class BFS {
+public:
+    static constexpr int ALPHA = 15;
+    static constexpr int BETA = 18;
+
+    explicit BFS(const csr::Graph& forward, const csr::Graph* backward = nullptr)
+        : fwd(forward), bwd(backward ? *backward : forward) {
+        int V = fwd.num_vertices();
+        r.level.resize(V);
+        r.parent.resize(V);
+        front.resize((V + 63) / 64);
+        next.resize(front.size());
+        buffers.resize(max_threads());
+    }
+
+    const BFSResult& run(int s) {
+        int V = fwd.num_vertices();
+        #pragma omp parallel for schedule(static)
+        for (int v = 0; v < V; v++) {
+            r.level[v] = -1;
+            r.parent[v] = -1;
+        }
+        r.depth = r.reached = r.bottom_up_steps = 0;
+        r.arcs_checked = 0;
+        queue.clear();
+        if (s < 0 || s >= V) return r;
+
+        r.level[s] = 0;
+        r.reached = 1;
+        queue.push_back(s);
+        long long unexplored = fwd.num_arcs(), scout = fwd.degree(s);
+        int depth = 0;
+        while (!queue.empty()) {
+            if (scout > unexplored / ALPHA) {
+                queue_to_bitmap();
+                long long awake = queue.size(), old;
+                do {
+                    old = awake;
+                    awake = bottom_up_step(depth++);
+                    r.reached += awake;
+                    r.bottom_up_steps++;
+                } while (awake >= old || awake > V / BETA);
+                bitmap_to_queue();
+                scout = 1;
+            } else {
+                unexplored -= scout;
+                scout = top_down_step(depth++);
+                r.reached += queue.size();
+            }
+        }
+        r.depth = depth - 1;
+        return r;
+    }
+
+private:
+    const csr::Graph& fwd;
+    const csr::Graph& bwd;
+    BFSResult r;
+    std::vector<int> queue;                 // frontier as a list
+    std::vector<uint64_t> front, next;      // frontier as bitmaps
+    std::vector<std::vector<int>> buffers;  // per-thread part of the next queue
+
+    static int thread_id() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    static int num_threads() {
+#ifdef _OPENMP
+        return omp_get_num_threads();
+#else
+        return 1;
+#endif
+    }
+
+    static int max_threads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    // Expands queue (level depth) into the next queue; returns the arcs out
+    // of the new frontier
+    long long top_down_step(int depth) {
+        long long scout = 0, checked = 0;
+        // Only the buffers of this team are cleared and filled; it may be
+        // smaller (or larger) than the team of an earlier step
+        size_t team = 1;
+        #pragma omp parallel reduction(+ : scout, checked)
+        {
+            #pragma omp single
+            {
+                team = num_threads();
+                if (buffers.size() < team) buffers.resize(team);
+            }
+            std::vector<int>& local = buffers[thread_id()];
+            local.clear();
+            #pragma omp for schedule(dynamic, 64)
+            for (size_t i = 0; i < queue.size(); i++) {
+                int u = queue[i];
+                for (uint32_t a = fwd.arc_begin(u); a < fwd.arc_end(u); a++) {
+                    int v = fwd.target(a);
+                    checked++;
+                    int unvisited = -1;
+                    if (__atomic_load_n(&r.level[v], __ATOMIC_RELAXED) < 0 &&
+                        __atomic_compare_exchange_n(&r.level[v], &unvisited, depth + 1, false, __ATOMIC_RELAXED,
+                                                    __ATOMIC_RELAXED)) {
+                        r.parent[v] = u;
+                        local.push_back(v);
+                        scout += fwd.degree(v);
+                    }
+                }
+            }
+        }
+        r.arcs_checked += checked;
+
+        // Concatenate the team's buffers
+        std::vector<size_t> start(team + 1, 0);
+        for (size_t t = 0; t < team; t++) start[t + 1] = start[t] + buffers[t].size();
+        queue.resize(start.back());
+        #pragma omp parallel for schedule(static, 1)
+        for (size_t t = 0; t < team; t++) std::copy(buffers[t].begin(), buffers[t].end(), queue.begin() + start[t]);
+        return scout;
+    }
+
+    // Finds the vertices of level depth + 1 from the front bitmap (level
+    // depth) into the next one, then swaps them; returns how many were found
+    long long bottom_up_step(int depth) {
+        int V = fwd.num_vertices();
+        long long awake = 0, checked = 0;
+        #pragma omp parallel for schedule(dynamic, 64) reduction(+ : awake, checked)
+        for (size_t w = 0; w < front.size(); w++) {
+            uint64_t bits = 0;
+            int lo = w * 64, hi = std::min(V, lo + 64);
+            for (int v = lo; v < hi; v++) {
+                if (r.level[v] >= 0) continue;
+                for (uint32_t a = bwd.arc_begin(v); a < bwd.arc_end(v); a++) {
+                    int u = bwd.target(a);
+                    checked++;
+                    if (front[u >> 6] >> (u & 63) & 1) {
+                        r.level[v] = depth + 1;
+                        r.parent[v] = u;
+                        bits |= 1ULL << (v - lo);
+                        awake++;
+                        break;
+                    }
+                }
+            }
+            next[w] = bits;
+        }
+        r.arcs_checked += checked;
+        front.swap(next);
+        return awake;
+    }
+
+    void queue_to_bitmap() {
+        std::fill(front.begin(), front.end(), 0);
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < queue.size(); i++)
+            __atomic_fetch_or(&front[queue[i] >> 6], 1ULL << (queue[i] & 63), __ATOMIC_RELAXED);
+    }
+
+    // Bitmap words are scanned in order, so the queue comes out sorted
+    void bitmap_to_queue() {
+        queue.clear();
+        for (size_t w = 0; w < front.size(); w++)
+            for (uint64_t bits = front[w]; bits; bits &= bits - 1)
+                queue.push_back(w * 64 + __builtin_ctzll(bits));
+    }
+};
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+// Connected components and label propagation on undirected CSR graphs, i.e.
+// every edge stored in both directions (what csr::load_graph builds by
+// default). Shared by the graph tools to split work by component.
+//
+// connected_components() is Afforest (Sutton et al.), a Shiloach-Vishkin
+// style union-find over one parent array shared by all threads:
+//   1. every vertex links to its first NEIGHBOR_ROUNDS neighbours and the
+//      trees are flattened; on most graphs this already joins the bulk
+//   2. a fixed sample of vertices names the most frequent root, almost
+//      surely the giant component
+//   3. the vertices outside it link all their remaining neighbours; those
+//      inside skip theirs, since an edge leaving the giant component is also
+//      seen from its other end.
+// Links always hang the higher root under the lower one, by compare-and-swap,
+// so every vertex ends up labelled with the smallest vertex of its component
+// whatever the thread schedule.
+//
+//     Components cc = Components::of(g);
+//     for (int c = 0; c < cc.count; c++)
+//         for (int v : cc.members(c)) ...        // ascending ids
+//
+// label_propagation() (Raghavan et al.) is a cheap community detector: each
+// vertex repeatedly adopts the label with the most arc weight among its
+// neighbours, until a sweep changes almost nothing. Sweeps are asynchronous:
+// threads update the labels in place and see each other's changes at once,
+// which converges in a few sweeps but makes the result schedule dependent.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+class Afforest {
+public:
+    static constexpr int NEIGHBOR_ROUNDS = 2;
+    static constexpr int SAMPLES = 1024;
+
+    // Smallest vertex of each vertex's component
+    static std::vector<int> run(const csr::Graph& g) {
+        int V = g.num_vertices();
+        std::vector<int> comp(V);
+        #pragma omp parallel for schedule(static)
+        for (int v = 0; v < V; v++) comp[v] = v;
+
+        for (int r = 0; r < NEIGHBOR_ROUNDS; r++) {
+            #pragma omp parallel for schedule(dynamic, 16384)
+            for (int v = 0; v < V; v++)
+                if ((int)g.degree(v) > r) link(v, g.target(g.arc_begin(v) + r), comp);
+            compress(comp);
+        }
+
+        int giant = most_frequent_root(comp);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int v = 0; v < V; v++) {
+            if (load(comp[v]) == giant) continue;
+            for (uint32_t a = g.arc_begin(v) + NEIGHBOR_ROUNDS; a < g.arc_end(v); a++) link(v, g.target(a), comp);
+        }
+        compress(comp);
+        return comp;
+    }
+
+private:
+    // Labels are read and written concurrently; relaxed atomics suffice since
+    // a label only ever moves to a smaller root
+    static int load(const int& x) { return __atomic_load_n(&x, __ATOMIC_RELAXED); }
+    static void store(int& x, int v) { __atomic_store_n(&x, v, __ATOMIC_RELAXED); }
+
+    // Joins the trees of u and v
+    static void link(int u, int v, std::vector<int>& comp) {
+        int p1 = load(comp[u]), p2 = load(comp[v]);
+        while (p1 != p2) {
+            int high = std::max(p1, p2), low = std::min(p1, p2);
+            int p_high = load(comp[high]);
+            if (p_high == low) break;
+            if (p_high == high &&
+                __atomic_compare_exchange_n(&comp[high], &p_high, low, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+            p1 = load(comp[load(comp[high])]);
+            p2 = load(comp[low]);
+        }
+    }
+
+    // Points every vertex straight at its root
+    static void compress(std::vector<int>& comp) {
+        int V = comp.size();
+        #pragma omp parallel for schedule(dynamic, 16384)
+        for (int v = 0; v < V; v++) {
+            int p = load(comp[v]);
+            while (p != load(comp[p])) p = load(comp[p]);
+            store(comp[v], p);
+        }
+    }
+
+    static int most_frequent_root(const std::vector<int>& comp) {
+        if (comp.empty()) return -1;
+        std::mt19937 rng(0);
+        std::uniform_int_distribution<int> pick(0, (int)comp.size() - 1);
+        std::unordered_map<int, int> seen;
+        int best = comp[0];
+        for (int i = 0; i < SAMPLES; i++) {
+            int c = comp[pick(rng)];
+            if (++seen[c] > seen[best]) best = c;
+        }
+        return best;
+    }
+};
+
+inline std::vector<int> connected_components(const csr::Graph& g) { return Afforest::run(g); }
+
+// Vertices grouped by component; components are numbered in order of their
+// smallest vertex
+struct Components {
+    int count = 0;
+    std::vector<int> id;      // component of each vertex
+    std::vector<int> offsets; // members of c: vertices[offsets[c], offsets[c+1])
+    std::vector<int> vertices;
+
+    static Components of(const csr::Graph& g) {
+        std::vector<int> root = connected_components(g);
+        int V = root.size();
+        Components cc;
+        cc.id.resize(V);
+        cc.offsets.assign(1, 0);
+        for (int v = 0; v < V; v++)
+            if (root[v] == v) {
+                cc.id[v] = cc.count++;
+                cc.offsets.push_back(0);
+            }
+        for (int v = 0; v < V; v++) {
+            cc.id[v] = cc.id[root[v]];
+            cc.offsets[cc.id[v] + 1]++;
+        }
+        for (int c = 0; c < cc.count; c++) cc.offsets[c + 1] += cc.offsets[c];
+        std::vector<int> cursor(cc.offsets.begin(), cc.offsets.end() - 1);
+        cc.vertices.resize(V);
+        for (int v = 0; v < V; v++) cc.vertices[cursor[cc.id[v]]++] = v;
+        return cc;
+    }
+
+    int size(int c) const { return offsets[c + 1] - offsets[c]; }
+    csr::Span<int> members(int c) const { return {vertices.data() + offsets[c], vertices.data() + offsets[c + 1]}; }
+
+    // Component with the most vertices, -1 for an empty graph
+    int largest() const {
+        int best = -1;
+        for (int c = 0; c < count; c++)
+            if (best < 0 || size(c) > size(best)) best = c;
+        return best;
+    }
+};
+
+// Community of each vertex, dense from 0. Stops after max_sweeps or once a
+// sweep changes fewer than min_changed * V labels. Ties keep the current
+// label if it is among the best, else go by a hash of (vertex, label): always
+// taking the smallest label would let small labels flood across communities.
+inline std::vector<int> label_propagation(const csr::Graph& g, int max_sweeps = 20, double min_changed = 1e-3) {
+    int V = g.num_vertices();
+    std::vector<int> label(V);
+    #pragma omp parallel for schedule(static)
+    for (int v = 0; v < V; v++) label[v] = v;
+
+    for (int sweep = 0; sweep < max_sweeps; sweep++) {
+        long long changed = 0;
+        #pragma omp parallel reduction(+ : changed)
+        {
+            std::vector<std::pair<int, double>> seen; // (label, weight) of the neighbours
+            #pragma omp for schedule(dynamic, 1024)
+            for (int u = 0; u < V; u++) {
+                if (g.degree(u) == 0) continue;
+                seen.clear();
+                for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++)
+                    seen.push_back({__atomic_load_n(&label[g.target(a)], __ATOMIC_RELAXED), g.weight(a)});
+                std::sort(seen.begin(), seen.end());
+
+                int own = __atomic_load_n(&label[u], __ATOMIC_RELAXED), best = own;
+                double best_weight = -1, own_weight = 0;
+                uint32_t best_hash = 0;
+                for (size_t i = 0; i < seen.size();) {
+                    int l = seen[i].first;
+                    double w = 0;
+                    for (; i < seen.size() && seen[i].first == l; i++) w += seen[i].second;
+                    if (l == own) own_weight = w;
+                    uint32_t h = ((uint32_t)l ^ ((uint32_t)u * 0x9E3779B1u)) * 0x85EBCA6Bu;
+                    if (w > best_weight || (w == best_weight && h < best_hash)) {
+                        best = l;
+                        best_weight = w;
+                        best_hash = h;
+                    }
+                }
+                if (own_weight >= best_weight || best == own) continue;
+                __atomic_store_n(&label[u], best, __ATOMIC_RELAXED);
+                changed++;
+            }
+        }
+        if (changed < min_changed * V) break;
+    }
+
+    // Labels are vertex ids; renumber them densely
+    std::vector<int> id(V, -1);
+    int count = 0;
+    for (int v = 0; v < V; v++)
+        if (id[label[v]] < 0) id[label[v]] = count++;
+    #pragma omp parallel for schedule(static)
+    for (int v = 0; v < V; v++) label[v] = id[label[v]];
+    return label;
+}
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef CSR_GRAPH_HPP
+#define CSR_GRAPH_HPP
+
+// Immutable compressed sparse row graph shared by the graph tools
+// (ShortestPathVisualizer, SocialNetworkAnalysis, MSTComparator).
+//
+// The arcs of vertex u are [offsets[u], offsets[u+1]) in two parallel arrays:
+// targets (int) and weights (double, absent for unweighted graphs). Offsets
+// are 32-bit, so a graph holds up to 2^32-1 arcs (an undirected edge is two
+// arcs). Each adjacency list is sorted by target.
+//
+// build() turns an edge list into CSR in three parallel passes: count the
+// degrees, prefix-sum them into offsets, scatter the arcs. The arrays are
+// shared between copies of a Graph and never modified after construction.
+//
+//     vector<csr::Edge> edges = {{0, 1, 2.5}, {1, 2, 1.0}};
+//     csr::Graph g = csr::Graph::build(3, edges);
+//     for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++)
+//         relax(g.target(a), g.weight(a));
+//     for (int v : g.neighbors(u)) ...
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace csr {
+
+struct Edge {
+    int u, v;
+    double weight;
+};
+
+// Read-only view of a contiguous slice of one of the arrays
+template <class T>
+struct Span {
+    const T* first = nullptr;
+    const T* last = nullptr;
+    const T* begin() const { return first; }
+    const T* end() const { return last; }
+    size_t size() const { return last - first; }
+    const T& operator[](size_t i) const { return first[i]; }
+};
+
+// In-place inclusive prefix sum: each thread scans its own block, then adds
+// the total of the blocks before it. Blocks are cut by the team that actually
+// runs, which can be smaller than omp_get_max_threads() (OMP_THREAD_LIMIT,
+// OMP_DYNAMIC, nested regions).
+template <class T>
+void parallel_prefix_sum(std::vector<T>& a) {
+    long long n = a.size();
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    if (n < 100000 || threads == 1) {
+        for (long long i = 1; i < n; i++) a[i] += a[i - 1];
+        return;
+    }
+    std::vector<T> block_sum;
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = 0, team = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        team = omp_get_num_threads();
+#endif
+        #pragma omp single
+        block_sum.assign(team + 1, 0);
+        long long lo = n * t / team, hi = n * (t + 1) / team;
+        for (long long i = lo + 1; i < hi; i++) a[i] += a[i - 1];
+        block_sum[t + 1] = hi > lo ? a[hi - 1] : 0;
+        #pragma omp barrier
+        #pragma omp single
+        for (int b = 1; b <= team; b++) block_sum[b] += block_sum[b - 1];
+        for (long long i = lo; i < hi; i++) a[i] += block_sum[t];
+    }
+}
+
+class Graph {
+public:
+    Graph() = default;
+
+    // Edge list to CSR. Undirected edges are stored in both directions.
+    // Throws std::out_of_range for a vertex outside [0, V) and
+    // std::length_error if the arcs do not fit 32-bit offsets.
+    static Graph build(int V, const std::vector<Edge>& edges, bool undirected = true, bool weighted = true) {
+        long long m = edges.size();
+        unsigned long long arcs = (unsigned long long)m * (undirected ? 2 : 1);
+        if (arcs > UINT32_MAX) throw std::length_error("csr::Graph: more than 2^32-1 arcs");
+        bool bad = false;
+        #pragma omp parallel for reduction(|| : bad)
+        for (long long i = 0; i < m; i++)
+            bad = bad || edges[i].u < 0 || edges[i].u >= V || edges[i].v < 0 || edges[i].v >= V;
+        if (bad) throw std::out_of_range("csr::Graph: edge endpoint outside [0, V)");
+
+        auto s = std::make_shared<Storage>();
+        s->offsets.assign((size_t)V + 1, 0);
+        s->targets.resize(arcs);
+        if (weighted) s->weights.resize(arcs);
+        uint32_t* deg = s->offsets.data() + 1;
+
+        // Locked increments stall on every cache miss; skip them when alone
+        bool serial = true;
+#ifdef _OPENMP
+        serial = omp_get_max_threads() == 1;
+#endif
+        auto claim = [serial](uint32_t& counter) {
+            uint32_t old;
+            if (serial) return counter++;
+            #pragma omp atomic capture
+            old = counter++;
+            return old;
+        };
+
+        // 1. degrees
+        #pragma omp parallel for
+        for (long long i = 0; i < m; i++) {
+            claim(deg[edges[i].u]);
+            if (undirected) claim(deg[edges[i].v]);
+        }
+
+        // 2. offsets
+        parallel_prefix_sum(s->offsets);
+
+        // 3. scatter, each arc claims the next free slot of its source
+        std::vector<uint32_t> cursor(s->offsets.begin(), s->offsets.end() - 1);
+        int* targets = s->targets.data();
+        double* weights = weighted ? s->weights.data() : nullptr;
+        #pragma omp parallel for
+        for (long long i = 0; i < m; i++) {
+            const Edge& e = edges[i];
+            uint32_t slot = claim(cursor[e.u]);
+            targets[slot] = e.v;
+            if (weights) weights[slot] = e.weight;
+            if (undirected) {
+                slot = claim(cursor[e.v]);
+                targets[slot] = e.u;
+                if (weights) weights[slot] = e.weight;
+            }
+        }
+
+        // Scatter order depends on the thread schedule; sorting makes it deterministic
+        #pragma omp parallel
+        {
+            std::vector<std::pair<int, double>> tmp;
+            #pragma omp for schedule(dynamic, 1024)
+            for (int u = 0; u < V; u++) {
+                uint32_t lo = s->offsets[u], hi = s->offsets[u + 1];
+                if (!weights) {
+                    std::sort(targets + lo, targets + hi);
+                    continue;
+                }
+                tmp.clear();
+                for (uint32_t a = lo; a < hi; a++) tmp.push_back({targets[a], weights[a]});
+                std::sort(tmp.begin(), tmp.end());
+                for (uint32_t a = lo; a < hi; a++) {
+                    targets[a] = tmp[a - lo].first;
+                    weights[a] = tmp[a - lo].second;
+                }
+            }
+        }
+
+        return view(V, (uint32_t)arcs, s->offsets.data(), s->targets.data(), weights, s);
+    }
+
+    // Graph over arrays that live elsewhere (e.g. a mapped file, see
+    // graph_io.hpp); `owner` is kept alive as long as any copy of the Graph
+    static Graph view(int V, uint32_t arcs, const uint32_t* offsets, const int* targets,
+                      const double* weights, std::shared_ptr<const void> owner) {
+        Graph g;
+        g.V_ = V;
+        g.arcs_ = arcs;
+        g.offsets_ = offsets;
+        g.targets_ = targets;
+        g.weights_ = weights;
+        g.owner_ = std::move(owner);
+        return g;
+    }
+
+    int num_vertices() const { return V_; }
+    uint32_t num_arcs() const { return arcs_; }
+    bool weighted() const { return weights_ != nullptr; }
+
+    uint32_t arc_begin(int u) const { return offsets_[u]; }
+    uint32_t arc_end(int u) const { return offsets_[u + 1]; }
+    uint32_t degree(int u) const { return offsets_[u + 1] - offsets_[u]; }
+    int target(uint32_t arc) const { return targets_[arc]; }
+    double weight(uint32_t arc) const { return weights_ ? weights_[arc] : 1.0; }
+
+    Span<int> neighbors(int u) const { return {targets_ + offsets_[u], targets_ + offsets_[u + 1]}; }
+
+    // Raw arrays (weights is null for unweighted graphs)
+    const uint32_t* offsets() const { return offsets_; }
+    const int* targets() const { return targets_; }
+    const double* weights() const { return weights_; }
+
+private:
+    struct Storage {
+        std::vector<uint32_t> offsets;
+        std::vector<int> targets;
+        std::vector<double> weights;
+    };
+
+    int V_ = 0;
+    uint32_t arcs_ = 0;
+    const uint32_t* offsets_ = nullptr;
+    const int* targets_ = nullptr;
+    const double* weights_ = nullptr;
+    std::shared_ptr<const void> owner_; // keeps the arrays alive
+};
+
+} // namespace csr
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef DARY_HEAP_HPP
+#define DARY_HEAP_HPP
+
+// Indexed d-ary min-heap over the ids 0..n-1 with a position map, so every id
+// is in the heap at most once and its key can be lowered in place
+// (decrease-key). Memory is O(n) however many updates are made, unlike a lazy
+// std::priority_queue which keeps every stale entry until it is popped.
+//
+// D = 4 keeps the tree shallow (log4 n levels) and the children of a node
+// in one or two cache lines, which pays off in sift-down.
+//
+//     IndexedDaryHeap<double> heap(V);
+//     heap.push_or_decrease(src, 0);
+//     while (!heap.empty()) {
+//         double d = heap.top_key();
+//         int u = heap.pop();
+//         ...
+//     }
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+template <class Key, int D = 4, class Compare = std::less<Key>>
+class IndexedDaryHeap {
+public:
+    explicit IndexedDaryHeap(int n = 0, Compare cmp = Compare()) : pos(n, -1), cmp(cmp) {}
+
+    // Empty heap for ids 0..n-1. clear() leaves every position at -1, so only
+    // the slots added when n grows need writing: O(size) otherwise
+    void reset(int n) {
+        clear();
+        pos.resize(n, -1);
+    }
+
+    // Empties the heap in O(size)
+    void clear() {
+        for (auto& e : heap) pos[e.id] = -1;
+        heap.clear();
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    bool contains(int id) const { return pos[id] >= 0; }
+    const Key& key(int id) const { return heap[pos[id]].key; }
+
+    int top() const { return heap[0].id; }
+    const Key& top_key() const { return heap[0].key; }
+
+    void push(int id, const Key& key) {
+        pos[id] = (int)heap.size();
+        heap.push_back({key, id});
+        sift_up(pos[id]);
+    }
+
+    // key must not be worse than the current one
+    void decrease_key(int id, const Key& key) {
+        int i = pos[id];
+        heap[i].key = key;
+        sift_up(i);
+    }
+
+    // Inserts id, or lowers its key if the new one is better.
+    // Returns false if nothing changed.
+    bool push_or_decrease(int id, const Key& key) {
+        if (pos[id] < 0) {
+            push(id, key);
+            return true;
+        }
+        if (!cmp(key, heap[pos[id]].key)) return false;
+        decrease_key(id, key);
+        return true;
+    }
+
+    // Removes and returns the id with the best key
+    int pop() {
+        int id = heap[0].id;
+        pos[id] = -1;
+        Entry last = std::move(heap.back());
+        heap.pop_back();
+        if (!heap.empty()) sift_down(0, std::move(last));
+        return id;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        int id;
+    };
+
+    std::vector<Entry> heap;
+    std::vector<int> pos; // index in heap, -1 if absent
+    Compare cmp;
+
+    // Hole-based sifts: entries are moved once per level, not swapped
+    void sift_up(int i) {
+        Entry e = std::move(heap[i]);
+        while (i > 0) {
+            int parent = (i - 1) / D;
+            if (!cmp(e.key, heap[parent].key)) break;
+            heap[i] = std::move(heap[parent]);
+            pos[heap[i].id] = i;
+            i = parent;
+        }
+        pos[e.id] = i;
+        heap[i] = std::move(e);
+    }
+
+    void sift_down(int i, Entry e) {
+        int n = (int)heap.size();
+        while (true) {
+            int first = D * i + 1;
+            if (first >= n) break;
+            int best = first, last = first + D < n ? first + D : n;
+            for (int c = first + 1; c < last; c++)
+                if (cmp(heap[c].key, heap[best].key)) best = c;
+            if (!cmp(heap[best].key, e.key)) break;
+            heap[i] = std::move(heap[best]);
+            pos[heap[i].id] = i;
+            i = best;
+        }
+        pos[e.id] = i;
+        heap[i] = std::move(e);
+    }
+};
+
+#endif
@@ -0,0 +1,481 @@
+#include <bits/stdc++.h>
+#include <unistd.h>
+#include "sortlib.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+// External-memory merge sort for int keys that do not fit in RAM.
+//  1. Run generation: read memory-sized runs, sort each in parallel with the
+//     in-memory engine and spill it to a binary temp file. The spill of run i
+//     overlaps reading run i+1 (write-behind).
+//  2. Merge: k-way merge of the runs through a loser tree. Every run has an
+//     async read-ahead buffer and the output has a write-behind buffer, so the
+//     disk is kept busy while the tree is being replayed. If there are more
+//     runs than the fan-in, intermediate passes merge them in groups first.
+//     The merge buffers share the --memory budget: they shrink to fit it,
+//     and the fan-in drops if even MIN_IO_ELEMS-sized buffers do not.
+//
+// Build: g++ -O2 -fopenmp external_sort.cpp -o external_sort
+// Usage: ./external_sort [options] <input> <output>
+//        ./external_sort --generate <count> [--text] <file>
+
+enum Format { BINARY, TEXT };
+
+struct Config {
+    Format format = BINARY;
+    size_t memoryBytes = size_t(256) << 20; // budget for run generation and each merge pass
+    size_t ioElems = size_t(1) << 20;       // ints per read-ahead / write-behind buffer (at most)
+    int fanIn = 128;                        // max runs merged in one pass (at most)
+    string tmpDir = ".";
+    bool check = false;
+};
+
+// ----------------- Input -----------------
+// Sequential reader for the user's input file (binary int32 or text).
+class InputReader {
+    FILE* f;
+    Format format;
+    vector<char> buf;
+    size_t pos = 0, len = 0;
+
+    bool fill() {
+        // keep the unparsed tail (a number may straddle two reads)
+        size_t rest = len - pos;
+        memmove(buf.data(), buf.data() + pos, rest);
+        len = rest + fread(buf.data() + rest, 1, buf.size() - rest, f);
+        pos = 0;
+        return len > rest;
+    }
+
+    // Whole token or nothing: "-", "1-2" and out-of-range numbers are errors
+    static int parseToken(const char* first, const char* last) {
+        int v = 0;
+        auto r = from_chars(first, last, v);
+        if (r.ec != errc() || r.ptr != last)
+            throw runtime_error("malformed number '" + string(first, last) + "' in input");
+        return v;
+    }
+
+    bool nextText(int& v) {
+        while (true) {
+            while (pos < len && !(isdigit((unsigned char)buf[pos]) || buf[pos] == '-')) pos++;
+            // need a whole token in the buffer before parsing it
+            size_t end = pos;
+            while (end < len && (isdigit((unsigned char)buf[end]) || buf[end] == '-')) end++;
+            if (pos < len && end < len) {
+                v = parseToken(buf.data() + pos, buf.data() + end);
+                pos = end;
+                return true;
+            }
+            if (!fill()) {
+                if (pos >= len) return false;
+                v = parseToken(buf.data() + pos, buf.data() + len);
+                pos = len;
+                return true;
+            }
+        }
+    }
+
+public:
+    InputReader(const string& filename, Format format) : format(format), buf(size_t(1) << 22) {
+        f = fopen(filename.c_str(), "rb");
+        if (!f) throw runtime_error("cannot open input " + filename);
+    }
+    ~InputReader() { fclose(f); }
+
+    // Fill out[0..maxCount); returns how many ints were read
+    size_t read(int* out, size_t maxCount) {
+        if (format == BINARY) return fread(out, sizeof(int), maxCount, f);
+        size_t n = 0;
+        while (n < maxCount && nextText(out[n])) n++;
+        return n;
+    }
+};
+
+// ----------------- Write-behind output -----------------
+// Two buffers: one is filled by the caller while the other is written by a
+// background task.
+class AsyncWriter {
+    FILE* f;
+    Format format;
+    vector<int> buf[2];
+    int cur = 0;
+    size_t n = 0;
+    future<void> pending;
+
+    static void writeBlock(FILE* f, Format format, const int* data, size_t count) {
+        if (format == BINARY) {
+            if (fwrite(data, sizeof(int), count, f) != count)
+                throw runtime_error("write failed");
+            return;
+        }
+        vector<char> text(count * 12);
+        char* p = text.data();
+        for (size_t i = 0; i < count; i++) {
+            p = to_chars(p, text.data() + text.size(), data[i]).ptr;
+            *p++ = '\n';
+        }
+        if (fwrite(text.data(), 1, p - text.data(), f) != size_t(p - text.data()))
+            throw runtime_error("write failed");
+    }
+
+public:
+    AsyncWriter(const string& filename, Format format, size_t capacity) : format(format) {
+        f = fopen(filename.c_str(), "wb");
+        if (!f) throw runtime_error("cannot create " + filename);
+        buf[0].resize(capacity);
+        buf[1].resize(capacity);
+    }
+
+    void push(int v) {
+        buf[cur][n++] = v;
+        if (n == buf[cur].size()) flush();
+    }
+
+    // Hand a whole sorted block to the background writer (no copy)
+    void writeAll(vector<int>& data, size_t count) {
+        flush();
+        if (pending.valid()) pending.get();
+        pending = async(launch::async, writeBlock, f, format, data.data(), count);
+    }
+
+    void flush() {
+        if (n == 0) return;
+        if (pending.valid()) pending.get();
+        pending = async(launch::async, writeBlock, f, format, buf[cur].data(), n);
+        cur ^= 1;
+        n = 0;
+    }
+
+    // Waits for the last block and reports its errors
+    void close() {
+        flush();
+        if (pending.valid()) pending.get();
+        fclose(f);
+        f = nullptr;
+    }
+
+    // Without close() (an exception unwinding): wait, drop errors, release the file
+    ~AsyncWriter() {
+        if (pending.valid()) pending.wait();
+        if (f) fclose(f);
+    }
+};
+
+// ----------------- Read-ahead run reader -----------------
+// While the merge consumes one buffer, the next one is being read.
+class RunReader {
+    FILE* f;
+    vector<int> buf[2];
+    size_t len[2] = {0, 0};
+    int cur = 0;
+    size_t pos = 0;
+    future<size_t> pending;
+
+    void prefetch(int which) {
+        int* dst = buf[which].data();
+        size_t cap = buf[which].size();
+        FILE* file = f;
+        pending = async(launch::async, [file, dst, cap] { return fread(dst, sizeof(int), cap, file); });
+    }
+
+public:
+    RunReader(const string& filename, size_t capacity) {
+        f = fopen(filename.c_str(), "rb");
+        if (!f) throw runtime_error("cannot open run " + filename);
+        buf[0].resize(capacity);
+        buf[1].resize(capacity);
+        prefetch(1);
+    }
+    ~RunReader() {
+        if (pending.valid()) pending.wait();
+        fclose(f);
+    }
+
+    bool next(int& v) {
+        if (pos == len[cur]) {
+            int other = cur ^ 1;
+            len[other] = pending.get();
+            cur = other;
+            pos = 0;
+            if (len[cur] == 0) return false;
+            prefetch(cur ^ 1);
+        }
+        v = buf[cur][pos++];
+        return true;
+    }
+};
+
+// ----------------- Loser tree -----------------
+// Internal nodes 1..k-1 hold the loser of their match, tree[0] the overall
+// winner; leaf j sits at position k+j. Replaying a leaf costs log2(k)
+// comparisons, one per level, against the stored losers only.
+class LoserTree {
+    int k;
+    vector<int> tree, keys;
+    vector<char> done;
+
+    bool beats(int a, int b) const {
+        if (done[a] != done[b]) return !done[a];
+        if (done[a]) return a < b;
+        return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+    }
+
+public:
+    explicit LoserTree(int k) : k(k), tree(max(k, 1)), keys(k), done(k, 1) {}
+
+    void set(int leaf, int key, bool exhausted) {
+        keys[leaf] = key;
+        done[leaf] = exhausted;
+    }
+
+    void build() {
+        vector<int> winner(2 * k);
+        for (int j = 0; j < k; j++) winner[k + j] = j;
+        for (int node = k - 1; node >= 1; node--) {
+            int a = winner[2 * node], b = winner[2 * node + 1];
+            winner[node] = beats(a, b) ? a : b;
+            tree[node] = beats(a, b) ? b : a;
+        }
+        tree[0] = k > 1 ? winner[1] : 0;
+    }
+
+    int top() const { return tree[0]; }
+    int topKey() const { return keys[tree[0]]; }
+    bool empty() const { return done[tree[0]]; }
+
+    // Leaf `leaf` (the last winner) has a new key; replay its path to the root
+    void replay(int leaf) {
+        int w = leaf;
+        for (int node = (k + leaf) / 2; node > 0; node /= 2)
+            if (beats(tree[node], w)) swap(tree[node], w);
+        tree[0] = w;
+    }
+};
+
+// ----------------- Temp files -----------------
+// Names the run files and removes whatever is left of them when it goes out
+// of scope, so that an exception does not leave runs behind
+class TempRuns {
+    string dir;
+    vector<string> names;
+
+public:
+    explicit TempRuns(const string& dir) : dir(dir) {}
+    ~TempRuns() {
+        for (auto& name : names) remove(name.c_str());
+    }
+
+    string create() {
+        names.push_back(dir + "/extsort_" + to_string(getpid()) + "_" + to_string(names.size()) + ".run");
+        return names.back();
+    }
+};
+
+// ----------------- In-memory run sort -----------------
+// Chunks are sorted in parallel, then merged pairwise (also in parallel)
+// with the vectorized merge.
+void parallelSortRun(vector<int>& data, vector<int>& tmp, size_t n) {
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    size_t chunk = (n + threads - 1) / max(threads, 1);
+    if (chunk == 0) return;
+    int chunks = (int)((n + chunk - 1) / chunk);
+
+    #pragma omp parallel for schedule(static)
+    for (int c = 0; c < chunks; c++) {
+        size_t lo = c * chunk, hi = min(n, lo + chunk);
+        // three-way partition: key dumps are often duplicate-heavy
+        sortlib::quickSort<sortlib::Median3Pivot, sortlib::ThreeWayPartition, sortlib::NetworkBase<32>>(
+            data.begin() + lo, data.begin() + hi);
+    }
+
+    int* src = data.data();
+    int* dst = tmp.data();
+    for (size_t width = chunk; width < n; width *= 2) {
+        long long pairs = (long long)((n + 2 * width - 1) / (2 * width));
+        #pragma omp parallel for schedule(dynamic)
+        for (long long p = 0; p < pairs; p++) {
+            size_t lo = p * 2 * width;
+            size_t mid = min(lo + width, n), hi = min(lo + 2 * width, n);
+            sortnet::mergeSorted(src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+        }
+        swap(src, dst);
+    }
+    if (src != data.data()) memcpy(data.data(), src, n * sizeof(int));
+}
+
+// Read the input in memory-sized runs, sort them and spill to temp files
+vector<string> generateRuns(const string& input, const Config& cfg, TempRuns& temp, size_t& total) {
+    // three run-sized buffers: the run being sorted, its merge scratch and
+    // the previous run still being written
+    size_t runElems = max<size_t>(cfg.memoryBytes / (3 * sizeof(int)), 1024);
+    vector<int> cur(runElems), tmp(runElems), writing(runElems);
+
+    InputReader in(input, cfg.format);
+    vector<string> runs;
+    unique_ptr<AsyncWriter> spill;
+    total = 0;
+    while (true) {
+        size_t n = in.read(cur.data(), runElems);
+        if (n == 0) break;
+        total += n;
+        parallelSortRun(cur, tmp, n);
+
+        if (spill) spill->close(); // previous run must be on disk before its buffer is reused
+        swap(cur, writing);
+        runs.push_back(temp.create());
+        spill = make_unique<AsyncWriter>(runs.back(), BINARY, 0);
+        spill->writeAll(writing, n);
+        cout << "Run " << runs.size() << ": " << n << " keys\n";
+    }
+    if (spill) spill->close();
+    return runs;
+}
+
+// k-way merge of sorted run files into out
+void mergeRuns(const vector<string>& runs, AsyncWriter& out, const Config& cfg) {
+    int k = runs.size();
+    if (k == 0) return; // empty input: out stays an empty file
+    vector<unique_ptr<RunReader>> readers;
+    for (auto& r : runs) readers.push_back(make_unique<RunReader>(r, cfg.ioElems));
+
+    LoserTree lt(k);
+    for (int j = 0; j < k; j++) {
+        int v = 0;
+        bool ok = readers[j]->next(v);
+        lt.set(j, v, !ok);
+    }
+    lt.build();
+    while (!lt.empty()) {
+        int j = lt.top();
+        out.push(lt.topKey());
+        int v = 0;
+        bool ok = readers[j]->next(v);
+        lt.set(j, v, !ok);
+        lt.replay(j);
+    }
+}
+
+// Smallest read-ahead / write-behind buffer worth a separate read
+const size_t MIN_IO_ELEMS = 4096;
+
+// A merge pass holds two buffers per input run and two for the output. They
+// are shrunk to fit memoryBytes, and the fan-in lowered if even buffers of
+// MIN_IO_ELEMS do not fit.
+Config fitMergeMemory(Config cfg) {
+    size_t ints = cfg.memoryBytes / sizeof(int);
+    size_t maxFanIn = ints / (2 * MIN_IO_ELEMS);
+    maxFanIn = maxFanIn > 1 ? maxFanIn - 1 : 0;
+    cfg.fanIn = (int)max<size_t>(2, min<size_t>(cfg.fanIn, maxFanIn));
+    cfg.ioElems = max(MIN_IO_ELEMS, min(cfg.ioElems, ints / (2 * (cfg.fanIn + 1))));
+    return cfg;
+}
+
+void externalSort(const string& input, const string& output, const Config& runCfg) {
+    Config cfg = fitMergeMemory(runCfg);
+    // Declared before any reader or writer, so it removes the files after them
+    TempRuns temp(cfg.tmpDir);
+    size_t total = 0;
+    vector<string> runs = generateRuns(input, cfg, temp, total);
+
+    // Intermediate passes while there are more runs than we can open at once
+    while ((int)runs.size() > cfg.fanIn) {
+        vector<string> next;
+        for (size_t i = 0; i < runs.size(); i += cfg.fanIn) {
+            vector<string> group(runs.begin() + i, runs.begin() + min(runs.size(), i + cfg.fanIn));
+            next.push_back(temp.create());
+            AsyncWriter w(next.back(), BINARY, cfg.ioElems);
+            mergeRuns(group, w, cfg);
+            w.close();
+            for (auto& r : group) remove(r.c_str());
+        }
+        cout << "Merge pass: " << runs.size() << " runs -> " << next.size() << "\n";
+        runs = next;
+    }
+
+    AsyncWriter out(output, cfg.format, cfg.ioElems);
+    mergeRuns(runs, out, cfg);
+    out.close();
+    for (auto& r : runs) remove(r.c_str());
+    cout << "Sorted " << total << " keys from " << input << " into " << output << "\n";
+}
+
+// ----------------- Helpers for experiments -----------------
+void generateInput(const string& filename, size_t count, Format format) {
+    mt19937 rng(time(0));
+    AsyncWriter w(filename, format, size_t(1) << 20);
+    for (size_t i = 0; i < count; i++) w.push((int)rng());
+    w.close();
+    cout << "Generated " << count << " random keys in " << filename << "\n";
+}
+
+bool checkSorted(const string& filename, Format format, size_t& count) {
+    InputReader in(filename, format);
+    vector<int> buf(size_t(1) << 20);
+    count = 0;
+    bool first = true;
+    int prev = 0;
+    size_t n;
+    while ((n = in.read(buf.data(), buf.size())) > 0) {
+        if (!first && buf[0] < prev) return false;
+        if (!is_sorted(buf.begin(), buf.begin() + n)) return false;
+        prev = buf[n - 1];
+        first = false;
+        count += n;
+    }
+    return true;
+}
+
+void usage(const char* prog) {
+    cerr << "Usage: " << prog << " [--text] [--memory MB] [--io-buffer MB] [--fan-in K]"
+         << " [--tmp DIR] [--check] <input> <output>\n"
+         << "       " << prog << " --generate <count> [--text] <file>\n";
+}
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    size_t generate = 0;
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--text") cfg.format = TEXT;
+        else if (arg == "--binary") cfg.format = BINARY;
+        else if (arg == "--memory" && i + 1 < argc) cfg.memoryBytes = size_t(atoll(argv[++i])) << 20;
+        else if (arg == "--io-buffer" && i + 1 < argc) cfg.ioElems = max<size_t>((size_t(atoll(argv[++i])) << 20) / sizeof(int), 1);
+        else if (arg == "--fan-in" && i + 1 < argc) cfg.fanIn = max(2, atoi(argv[++i]));
+        else if (arg == "--tmp" && i + 1 < argc) cfg.tmpDir = argv[++i];
+        else if (arg == "--check") cfg.check = true;
+        else if (arg == "--generate" && i + 1 < argc) generate = atoll(argv[++i]);
+        else if (!arg.empty() && arg[0] == '-') { usage(argv[0]); return 1; }
+        else files.push_back(arg);
+    }
+
+    try {
+        if (generate > 0) {
+            if (files.size() != 1) { usage(argv[0]); return 1; }
+            generateInput(files[0], generate, cfg.format);
+            return 0;
+        }
+        if (files.size() != 2) { usage(argv[0]); return 1; }
+
+        auto start = chrono::steady_clock::now();
+        externalSort(files[0], files[1], cfg);
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Time: " << secs << " sec\n";
+
+        if (cfg.check) {
+            size_t count = 0;
+            bool sorted = checkSorted(files[1], cfg.format, count);
+            cout << "Output sorted correctly? " << (sorted ? "YES" : "NO") << " (" << count << " keys)\n";
+        }
+    } catch (const exception& e) {
+        cerr << "external_sort: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
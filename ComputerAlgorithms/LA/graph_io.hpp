@@ -0,0 +1,370 @@
+#ifndef GRAPH_IO_HPP
+#define GRAPH_IO_HPP
+
+// Graph files for the CSR graph tools.
+//
+// Text edge lists ("u v [weight]" per line, the edges.txt format) are parsed
+// by all threads at once: the file is mapped, cut into one slice per thread
+// at line boundaries, and each slice is parsed with from_chars. Blank lines
+// and lines starting with '#' or '%' are skipped; a missing weight is 1.
+//
+// The binary container is the CSR arrays as they sit in memory, so loading
+// it is one mmap, the header checks and one parallel pass validating the
+// offsets and targets, no parsing:
+//
+//     offset 0   Header (64 bytes, see below)
+//     ...        offsets  uint32[V + 1]    each array starts 64-byte aligned
+//     ...        targets  int32[arcs]
+//     ...        weights  double[arcs]     only if FLAG_WEIGHTED
+//
+// Files are native little-endian; a file written on a different byte order
+// is rejected by the endian tag. Bump VERSION on any layout change.
+//
+//     csr::Graph g = csr::load_graph("edges.txt");   // text or binary, by magic
+//     csr::save_binary(g, "graph.csr", true);
+//
+// Errors are reported with std::runtime_error.
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GRAPH_IO_MMAP 1
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "csr_graph.hpp"
+
+namespace csr {
+
+const char MAGIC[8] = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+const uint32_t VERSION = 1;
+const uint32_t ENDIAN_TAG = 0x01020304;
+const uint32_t FLAG_WEIGHTED = 1;
+const uint32_t FLAG_UNDIRECTED = 2; // every edge is stored as two arcs
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_tag;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t num_vertices;
+    uint64_t num_arcs;
+    uint64_t offsets_pos; // byte positions of the arrays
+    uint64_t targets_pos;
+    uint64_t weights_pos; // 0 if unweighted
+};
+static_assert(sizeof(Header) == 64, "graph file header must stay 64 bytes");
+
+// Read-only view of a whole file: mmap where available, a heap copy otherwise
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+#ifdef GRAPH_IO_MMAP
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open " + filename);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("cannot stat " + filename);
+        }
+        size_ = st.st_size;
+        if (size_ > 0) {
+            void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("cannot mmap " + filename);
+            }
+            data_ = (const char*)p;
+        }
+        close(fd);
+#else
+        std::ifstream f(filename, std::ios::binary);
+        if (!f) throw std::runtime_error("cannot open " + filename);
+        copy_.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        data_ = copy_.data();
+        size_ = copy_.size();
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef GRAPH_IO_MMAP
+        if (data_) munmap((void*)data_, size_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifndef GRAPH_IO_MMAP
+    std::vector<char> copy_;
+#endif
+};
+
+inline bool is_binary_graph(const MappedFile& f) {
+    return f.size() >= sizeof(MAGIC) && memcmp(f.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+// ----------------- Binary container -----------------
+inline uint64_t align64(uint64_t pos) { return (pos + 63) & ~uint64_t(63); }
+
+inline void save_binary(const Graph& g, const std::string& filename, bool undirected) {
+    uint64_t V = g.num_vertices(), arcs = g.num_arcs();
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.endian_tag = ENDIAN_TAG;
+    h.flags = (g.weighted() ? FLAG_WEIGHTED : 0) | (undirected ? FLAG_UNDIRECTED : 0);
+    h.num_vertices = V;
+    h.num_arcs = arcs;
+    h.offsets_pos = align64(sizeof(Header));
+    h.targets_pos = align64(h.offsets_pos + (V + 1) * sizeof(uint32_t));
+    h.weights_pos = g.weighted() ? align64(h.targets_pos + arcs * sizeof(int)) : 0;
+
+    std::ofstream f(filename, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot create " + filename);
+    auto write_at = [&](uint64_t pos, const void* p, uint64_t bytes) {
+        static const char zeros[64] = {};
+        f.write(zeros, pos - (uint64_t)f.tellp()); // alignment padding
+        f.write((const char*)p, bytes);
+    };
+    f.write((const char*)&h, sizeof(h));
+    write_at(h.offsets_pos, g.offsets(), (V + 1) * sizeof(uint32_t));
+    write_at(h.targets_pos, g.targets(), arcs * sizeof(int));
+    if (g.weighted()) write_at(h.weights_pos, g.weights(), arcs * sizeof(double));
+    if (!f) throw std::runtime_error("write failed: " + filename);
+}
+
+// Graph over the mapped file itself; the mapping lives as long as the Graph
+inline Graph load_binary(std::shared_ptr<MappedFile> file, const std::string& filename, bool* undirected = nullptr) {
+    auto fail = [&](const std::string& why) { throw std::runtime_error(filename + ": " + why); };
+    if (file->size() < sizeof(Header)) fail("too small for a graph header");
+    Header h;
+    memcpy(&h, file->data(), sizeof(h));
+    if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) fail("not a binary graph file");
+    if (h.endian_tag != ENDIAN_TAG) fail("written on a machine with a different byte order");
+    if (h.version != VERSION) fail("unsupported version " + std::to_string(h.version));
+    if (h.num_vertices > (uint64_t)INT_MAX || h.num_arcs > UINT32_MAX) fail("graph too large");
+
+    bool weighted = h.flags & FLAG_WEIGHTED;
+    auto fits = [&](uint64_t pos, uint64_t bytes) {
+        return pos % 64 == 0 && pos >= sizeof(Header) && pos <= file->size() && bytes <= file->size() - pos;
+    };
+    if (!fits(h.offsets_pos, (h.num_vertices + 1) * sizeof(uint32_t)) ||
+        !fits(h.targets_pos, h.num_arcs * sizeof(int)) ||
+        (weighted && !fits(h.weights_pos, h.num_arcs * sizeof(double))))
+        fail("truncated or corrupt array table");
+
+    const char* base = file->data();
+    const uint32_t* offsets = (const uint32_t*)(base + h.offsets_pos);
+    const int* targets = (const int*)(base + h.targets_pos);
+    if (offsets[0] != 0 || offsets[h.num_vertices] != h.num_arcs) fail("offsets do not match the arc count");
+
+    // One pass over the vertices: every arc range must be in order and within
+    // the arcs, which makes it safe to check the targets it covers
+    int V = (int)h.num_vertices;
+    uint32_t arcs = (uint32_t)h.num_arcs;
+    long long bad_offsets = 0, bad_targets = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : bad_offsets, bad_targets)
+    for (int u = 0; u < V; u++) {
+        uint32_t lo = offsets[u], hi = offsets[u + 1];
+        if (lo > hi || hi > arcs) {
+            bad_offsets++;
+            continue;
+        }
+        for (uint32_t a = lo; a < hi; a++)
+            if ((uint32_t)targets[a] >= (uint32_t)V) bad_targets++;
+    }
+    if (bad_offsets) fail("offsets are not non-decreasing");
+    if (bad_targets) fail(std::to_string(bad_targets) + " arc targets outside [0, V)");
+
+    if (undirected) *undirected = h.flags & FLAG_UNDIRECTED;
+    return Graph::view(V, arcs, offsets, targets, weighted ? (const double*)(base + h.weights_pos) : nullptr, file);
+}
+
+// ----------------- Text edge lists -----------------
+struct EdgeList {
+    int V = 0;              // 1 + largest vertex id
+    bool weighted = false;  // some line had a third column
+    std::vector<Edge> edges;
+};
+
+// Parses [first, last), which starts at a line boundary. Returns the position
+// of the first malformed line, or nullptr.
+inline const char* parse_edges(const char* first, const char* last, std::vector<Edge>& out,
+                               int& max_id, bool& weighted) {
+    const char* p = first;
+    auto skip_blanks = [&]() { while (p < last && (*p == ' ' || *p == '\t' || *p == '\r')) p++; };
+    while (p < last) {
+        const char* line = p;
+        skip_blanks();
+        if (p == last) break;
+        if (*p == '\n' || *p == '#' || *p == '%') {
+            while (p < last && *p != '\n') p++;
+            p++;
+            continue;
+        }
+        Edge e{0, 0, 1.0};
+        auto r = std::from_chars(p, last, e.u);
+        if (r.ec != std::errc() || e.u < 0) return line;
+        p = r.ptr;
+        skip_blanks();
+        r = std::from_chars(p, last, e.v);
+        if (r.ec != std::errc() || e.v < 0) return line;
+        p = r.ptr;
+        skip_blanks();
+        if (p < last && *p != '\n') {
+            auto rw = std::from_chars(p, last, e.weight);
+            if (rw.ec != std::errc()) return line;
+            p = rw.ptr;
+            weighted = true;
+            skip_blanks();
+        }
+        if (p < last && *p != '\n') return line;
+        p++;
+        out.push_back(e);
+        max_id = std::max(max_id, std::max(e.u, e.v));
+    }
+    return nullptr;
+}
+
+inline EdgeList parse_edge_list(const MappedFile& file, const std::string& filename) {
+    const char* data = file.data();
+    size_t size = file.size();
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    if (size < (1 << 20)) threads = 1; // not worth it for small files
+
+    // Slice boundaries moved forward to the next line start
+    std::vector<size_t> cut(threads + 1, size);
+    cut[0] = 0;
+    for (int t = 1; t < threads; t++) {
+        size_t pos = std::max(size * t / threads, cut[t - 1]);
+        while (pos < size && data[pos - 1] != '\n') pos++;
+        cut[t] = pos;
+    }
+
+    std::vector<std::vector<Edge>> parts(threads);
+    std::vector<int> max_id(threads, -1);
+    std::vector<char> weighted(threads, 0);
+    std::vector<const char*> error(threads, nullptr);
+    #pragma omp parallel for schedule(static, 1) num_threads(threads)
+    for (int t = 0; t < threads; t++) {
+        bool w = false;
+        parts[t].reserve((cut[t + 1] - cut[t]) / 8);
+        error[t] = parse_edges(data + cut[t], data + cut[t + 1], parts[t], max_id[t], w);
+        weighted[t] = w;
+    }
+
+    for (int t = 0; t < threads; t++) {
+        if (!error[t]) continue;
+        long long line = 1 + std::count(data, error[t], '\n');
+        throw std::runtime_error(filename + ":" + std::to_string(line) + ": expected \"u v [weight]\"");
+    }
+
+    // Concatenate in file order
+    EdgeList list;
+    std::vector<size_t> start(threads + 1, 0);
+    for (int t = 0; t < threads; t++) {
+        start[t + 1] = start[t] + parts[t].size();
+        list.V = std::max(list.V, max_id[t] + 1);
+        list.weighted = list.weighted || weighted[t];
+    }
+    list.edges.resize(start[threads]);
+    #pragma omp parallel for schedule(static, 1) num_threads(threads)
+    for (int t = 0; t < threads; t++) {
+        std::copy(parts[t].begin(), parts[t].end(), list.edges.begin() + start[t]);
+        std::vector<Edge>().swap(parts[t]);
+    }
+    return list;
+}
+
+inline EdgeList parse_edge_list(const std::string& filename) {
+    MappedFile file(filename);
+    return parse_edge_list(file, filename);
+}
+
+// One line per stored edge: each undirected edge once (u < v; self loops
+// once per pair of arcs), all arcs of a directed graph
+inline void save_edge_list(const Graph& g, const std::string& filename, bool undirected) {
+    std::ofstream f(filename);
+    if (!f) throw std::runtime_error("cannot create " + filename);
+    std::string out;
+    auto put = [&out](auto x) {
+        char buf[32];
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), x).ptr);
+    };
+    bool odd_loop = false; // an undirected self loop is two arcs u->u; write one
+    for (int u = 0; u < g.num_vertices(); u++) {
+        for (uint32_t a = g.arc_begin(u); a < g.arc_end(u); a++) {
+            int v = g.target(a);
+            if (undirected && (v < u || (v == u && (odd_loop = !odd_loop)))) continue;
+            put(u);
+            out += ' ';
+            put(v);
+            if (g.weighted()) {
+                out += ' ';
+                put(g.weight(a));
+            }
+            out += '\n';
+            if (out.size() > (1 << 20)) {
+                f.write(out.data(), out.size());
+                out.clear();
+            }
+        }
+    }
+    f.write(out.data(), out.size());
+    if (!f) throw std::runtime_error("write failed: " + filename);
+}
+
+// Text or binary, told apart by the magic bytes. Text edge lists are taken as
+// undirected unless `undirected` is false; vertex count is 1 + largest id, or
+// min_vertices if that is larger. A binary file is a fixed view, so it must
+// have been stored the same way (directed or not) and hold at least
+// min_vertices vertices.
+inline Graph load_graph(const std::string& filename, bool undirected = true, int min_vertices = 0) {
+    auto file = std::make_shared<MappedFile>(filename);
+    if (is_binary_graph(*file)) {
+        bool file_undirected = false;
+        Graph g = load_binary(file, filename, &file_undirected);
+        auto kind = [](bool u) { return u ? std::string("undirected") : std::string("directed"); };
+        if (file_undirected != undirected)
+            throw std::runtime_error(filename + ": stored as " + kind(file_undirected) + ", expected " +
+                                     kind(undirected));
+        if (g.num_vertices() < min_vertices)
+            throw std::runtime_error(filename + ": has " + std::to_string(g.num_vertices()) +
+                                     " vertices, fewer than the " + std::to_string(min_vertices) + " required");
+        return g;
+    }
+    EdgeList list = parse_edge_list(*file, filename);
+    return Graph::build(std::max(list.V, min_vertices), list.edges, undirected, list.weighted);
+}
+
+} // namespace csr
+
+#endif
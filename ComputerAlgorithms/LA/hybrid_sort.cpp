@@ -1,75 +1,228 @@
 #include <bits/stdc++.h>
+#include "sortlib.hpp"
+#include "adaptive_sort.hpp"
+#include "stable_sort.hpp"
+#include "perf_counters.hpp"
 using namespace std;
 
-int THRESHOLD = 10; // can tune this value
+int THRESHOLD = 10; // default; overridden by the tuned profile or setThreshold()
 
-struct Metrics {
-    long long comparisons = 0;
-    long long swaps = 0;
-    long long recursiveCalls = 0;
-} metrics;
+// How partitions of THRESHOLD elements or fewer are finished
+enum BaseCase { INSERTION, NETWORK };
+BaseCase BASE_CASE = INSERTION;
 
-void swapCount(int &a, int &b) {
-    swap(a, b);
-    metrics.swaps++;
+const string PROFILE_FILE = "hybrid_sort.profile";
+
+// Counting instrumentation from sortlib (comparisons, swaps, recursive calls)
+using Metrics = sortlib::CountingStats;
+Metrics metrics;
+
+PerfCounters counters; // hardware events for each experiment (n/a if unsupported)
+
+// Last-element pivot + Lomuto partition; partitions of THRESHOLD elements or
+// fewer are finished by BASE_CASE (network leaves are branch-free and are not
+// counted). Stats is Metrics for the experiments and NoStats for timing.
+template <class Stats>
+void hybridQuickSort(vector<int>& arr, int low, int high, Stats& stats) {
+    if (low >= high) return;
+    auto first = arr.begin() + low, last = arr.begin() + high + 1;
+    if (BASE_CASE == NETWORK)
+        sortlib::quickSort(first, last, less<int>(), stats, sortlib::LastPivot(),
+                           sortlib::LomutoPartition(), sortlib::NetworkBase<>{THRESHOLD});
+    else
+        sortlib::quickSort(first, last, less<int>(), stats, sortlib::LastPivot(),
+                           sortlib::LomutoPartition(), sortlib::InsertionBase<>{THRESHOLD});
 }
 
-void insertionSort(vector<int>& arr, int low, int high) {
-    for (int i = low + 1; i <= high; ++i) {
-        int key = arr[i];
-        int j = i - 1;
-        while (j >= low && arr[j] > key) {
-            metrics.comparisons++;
-            arr[j + 1] = arr[j];
-            metrics.swaps++;
-            j--;
+void hybridQuickSort(vector<int>& arr, int low, int high) {
+    hybridQuickSort(arr, low, high, metrics);
+}
+
+// ----------------- Cutoff overrides -----------------
+void setThreshold(int t) { THRESHOLD = max(1, t); }
+
+void setBaseCase(BaseCase b) { BASE_CASE = b; }
+
+const char* baseCaseName(BaseCase b) { return b == NETWORK ? "network" : "insertion"; }
+
+bool parseBaseCase(const string& s, BaseCase& out) {
+    if (s == "network") { out = NETWORK; return true; }
+    if (s == "insertion") { out = INSERTION; return true; }
+    return false;
+}
+
+// ----------------- Per-machine profile -----------------
+// The profile is tied to the CPU it was tuned on; a copy from a different
+// machine is ignored rather than silently applied.
+string cpuSignature() {
+    ifstream fin("/proc/cpuinfo");
+    string line;
+    while (getline(fin, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            size_t colon = line.find(':');
+            if (colon != string::npos && colon + 2 <= line.size()) return line.substr(colon + 2);
         }
-        arr[j + 1] = key;
     }
+    return "unknown";
 }
 
-int partition(vector<int>& arr, int low, int high) {
-    int pivot = arr[high];
-    int i = low - 1;
-    for (int j = low; j < high; ++j) {
-        metrics.comparisons++;
-        if (arr[j] < pivot) {
-            i++;
-            swapCount(arr[i], arr[j]);
-        }
+bool loadProfile(const string& filename) {
+    ifstream fin(filename);
+    if (!fin) return false;
+
+    int threshold = THRESHOLD;
+    BaseCase base = BASE_CASE;
+    string cpu, line;
+    while (getline(fin, line)) {
+        size_t eq = line.find('=');
+        if (line.empty() || line[0] == '#' || eq == string::npos) continue;
+        string key = line.substr(0, eq), value = line.substr(eq + 1);
+        if (key == "threshold") threshold = atoi(value.c_str());
+        else if (key == "base_case") parseBaseCase(value, base);
+        else if (key == "cpu") cpu = value;
     }
-    swapCount(arr[i + 1], arr[high]);
-    return i + 1;
+    if (cpu != cpuSignature()) {
+        cout << "Ignoring " << filename << ": tuned on a different CPU (" << cpu << ")\n";
+        return false;
+    }
+    setThreshold(threshold);
+    setBaseCase(base);
+    return true;
 }
 
-void hybridQuickSort(vector<int>& arr, int low, int high) {
-    if (low < high) {
-        int size = high - low + 1;
-        if (size <= THRESHOLD) {
-            insertionSort(arr, low, high);
-            return;
+bool saveProfile(const string& filename) {
+    ofstream fout(filename);
+    if (!fout) return false;
+    fout << "# hybrid_sort autotune profile\n";
+    fout << "cpu=" << cpuSignature() << "\n";
+    fout << "simd=" << sortnet::simdName(sortnet::simdLevel()) << "\n";
+    fout << "threshold=" << THRESHOLD << "\n";
+    fout << "base_case=" << baseCaseName(BASE_CASE) << "\n";
+    return true;
+}
+
+// ----------------- Autotuning -----------------
+// Times every (cutoff, base case) pair on random and duplicate-heavy inputs
+// of a few sizes and keeps the pair with the lowest total median time.
+// Sorted inputs are left out: with the last-element pivot they measure the
+// quadratic partition, not the leaves.
+void autotune() {
+    const vector<int> cutoffs = {4, 8, 12, 16, 24, 32, 48, 64};
+    const vector<int> sizes = {1000, 10000, 100000};
+    const int REPS = 5;
+
+    mt19937 rng(12345);
+    vector<vector<int>> inputs;
+    for (int n : sizes) {
+        vector<int> randomArr(n), dupArr(n);
+        for (int i = 0; i < n; i++) randomArr[i] = rng();
+        for (int i = 0; i < n; i++) dupArr[i] = rng() % 1000;
+        inputs.push_back(randomArr);
+        inputs.push_back(dupArr);
+    }
+
+    cout << "===== Autotuning cutoff and base case =====\n";
+    double bestTime = 1e18;
+    int bestCutoff = THRESHOLD;
+    BaseCase bestBase = BASE_CASE;
+    for (BaseCase base : {INSERTION, NETWORK}) {
+        for (int cutoff : cutoffs) {
+            setThreshold(cutoff);
+            setBaseCase(base);
+            double total = 0;
+            for (auto& input : inputs) {
+                vector<double> times;
+                for (int r = 0; r < REPS; r++) {
+                    vector<int> arr = input;
+                    sortlib::NoStats none; // time the engine without counters
+                    auto start = chrono::steady_clock::now();
+                    hybridQuickSort(arr, 0, arr.size() - 1, none);
+                    times.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+                }
+                nth_element(times.begin(), times.begin() + REPS / 2, times.end());
+                total += times[REPS / 2];
+            }
+            cout << "cutoff=" << cutoff << " base_case=" << baseCaseName(base)
+                 << " time=" << total << " sec\n";
+            if (total < bestTime) {
+                bestTime = total;
+                bestCutoff = cutoff;
+                bestBase = base;
+            }
         }
-        metrics.recursiveCalls++;
-        int pi = partition(arr, low, high);
-        hybridQuickSort(arr, low, pi - 1);
-        hybridQuickSort(arr, pi + 1, high);
     }
+    setThreshold(bestCutoff);
+    setBaseCase(bestBase);
+    cout << "Best: cutoff=" << bestCutoff << " base_case=" << baseCaseName(bestBase) << "\n";
 }
 
 void runExperiment(vector<int> arr, const string& name) {
     metrics = {};
     clock_t start = clock();
+    counters.start();
     hybridQuickSort(arr, 0, arr.size() - 1);
+    counters.stop();
     double duration = double(clock() - start) / CLOCKS_PER_SEC;
     cout << "\n--- " << name << " ---\n";
     cout << "Threshold: " << THRESHOLD << "\n";
+    cout << "Base Case: " << (BASE_CASE == NETWORK ? "Sorting Network" : "Insertion Sort") << "\n";
     cout << "Comparisons: " << metrics.comparisons << "\n";
     cout << "Swaps: " << metrics.swaps << "\n";
     cout << "Recursive Calls: " << metrics.recursiveCalls << "\n";
     cout << "Time: " << duration << " sec\n";
+    counters.print(cout);
+}
+
+// Run-adaptive merge sort on the same input; Recursive Calls counts merges
+void runAdaptiveExperiment(vector<int> arr, const string& name) {
+    metrics = {};
+    clock_t start = clock();
+    counters.start();
+    sortlib::adaptiveSort(arr.begin(), arr.end(), less<int>(), metrics);
+    counters.stop();
+    double duration = double(clock() - start) / CLOCKS_PER_SEC;
+    cout << "\n--- " << name << " ---\n";
+    cout << "Comparisons: " << metrics.comparisons << "\n";
+    cout << "Swaps: " << metrics.swaps << "\n";
+    cout << "Merges: " << metrics.recursiveCalls << "\n";
+    cout << "Time: " << duration << " sec\n";
+    counters.print(cout);
 }
 
-int main() {
+void usage(const char* prog) {
+    cerr << "Usage: " << prog << " [--tune] [--profile FILE] [--threshold N]"
+         << " [--base-case insertion|network]\n";
+}
+
+int main(int argc, char* argv[]) {
+    string profile = PROFILE_FILE;
+    bool tune = false;
+    int threshold = -1;
+    string baseCase;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--tune") tune = true;
+        else if (arg == "--profile" && i + 1 < argc) profile = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc) threshold = atoi(argv[++i]);
+        else if (arg == "--base-case" && i + 1 < argc) baseCase = argv[++i];
+        else { usage(argv[0]); return 1; }
+    }
+
+    if (tune) {
+        autotune();
+        if (saveProfile(profile)) cout << "Profile saved to " << profile << "\n\n";
+    } else if (loadProfile(profile)) {
+        cout << "Loaded profile " << profile << "\n";
+    }
+
+    // Explicit flags win over the profile
+    if (threshold > 0) setThreshold(threshold);
+    if (!baseCase.empty()) {
+        BaseCase b;
+        if (!parseBaseCase(baseCase, b)) { usage(argv[0]); return 1; }
+        setBaseCase(b);
+    }
+
     srand(time(0));
     const int N = 10000;
 
@@ -87,9 +240,68 @@ int main() {
     vector<int> fewUniqueArr(N);
     for (int i = 0; i < N; i++) fewUniqueArr[i] = rand() % 5;
 
-    cout << "===== Hybrid QuickSort + Insertion Sort =====\n";
+    // Sorted with 1% of the positions swapped at random
+    vector<int> nearlySortedArr = sortedArr;
+    for (int i = 0; i < N / 100; i++) swap(nearlySortedArr[rand() % N], nearlySortedArr[rand() % N]);
+
+    cout << "===== Hybrid QuickSort + "
+         << (BASE_CASE == NETWORK ? "Sorting Network" : "Insertion Sort") << " =====\n";
     runExperiment(randomArr, "Random Input");
     runExperiment(sortedArr, "Sorted Input");
     runExperiment(reverseArr, "Reverse Sorted Input");
     runExperiment(fewUniqueArr, "Few Unique Elements");
+    runExperiment(nearlySortedArr, "Nearly Sorted Input");
+
+    // Same quicksort, leaves finished by the bitonic network (padded to 16)
+    int savedThreshold = THRESHOLD;
+    BaseCase savedBase = BASE_CASE;
+    setBaseCase(NETWORK);
+    setThreshold(16);
+    cout << "\n===== Hybrid QuickSort + Sorting Network ("
+         << sortnet::simdName(sortnet::simdLevel()) << ") =====\n";
+    runExperiment(randomArr, "Random Input");
+    runExperiment(sortedArr, "Sorted Input");
+    runExperiment(reverseArr, "Reverse Sorted Input");
+    runExperiment(fewUniqueArr, "Few Unique Elements");
+    setThreshold(savedThreshold);
+    setBaseCase(savedBase);
+
+    // Presorted inputs are the quicksort worst case but the common case in practice
+    cout << "\n===== Adaptive Run Merge Sort (powersort + galloping) =====\n";
+    runAdaptiveExperiment(randomArr, "Random Input");
+    runAdaptiveExperiment(sortedArr, "Sorted Input");
+    runAdaptiveExperiment(reverseArr, "Reverse Sorted Input");
+    runAdaptiveExperiment(fewUniqueArr, "Few Unique Elements");
+    runAdaptiveExperiment(nearlySortedArr, "Nearly Sorted Input");
+
+    // 64-element network blocks combined with the vectorized merge
+    cout << "\n===== Block Merge Sort (network leaves + SIMD merge) =====\n";
+    vector<pair<vector<int>, string>> inputs = {
+        {randomArr, "Random Input"}, {sortedArr, "Sorted Input"},
+        {reverseArr, "Reverse Sorted Input"}, {fewUniqueArr, "Few Unique Elements"}};
+    for (auto &in : inputs) {
+        vector<int> arr = in.first;
+        clock_t start = clock();
+        sortnet::blockMergeSort(arr.data(), arr.size());
+        double duration = double(clock() - start) / CLOCKS_PER_SEC;
+        cout << "\n--- " << in.second << " ---\n";
+        cout << "Sorted: " << (is_sorted(arr.begin(), arr.end()) ? "YES" : "NO") << "\n";
+        cout << "Time: " << duration << " sec\n";
+    }
+
+    // Records ordered by two keys, minor first: only correct if the sort is stable
+    cout << "\n===== Parallel Stable Merge Sort (records, two keys) =====\n";
+    struct Record { int major, minor, id; };
+    vector<Record> records(N);
+    for (int i = 0; i < N; i++) records[i] = {fewUniqueArr[i], randomArr[i], i};
+    sortlib::StableSorter<Record> sorter; // scratch buffer shared by both passes
+    clock_t start = clock();
+    sorter.sort(records.begin(), records.end(), [](const Record& r) { return r.minor; });
+    sorter.sort(records.begin(), records.end(), [](const Record& r) { return r.major; });
+    double duration = double(clock() - start) / CLOCKS_PER_SEC;
+    bool ordered = is_sorted(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return make_pair(a.major, a.minor) < make_pair(b.major, b.minor);
+    });
+    cout << "Sorted by (major, minor): " << (ordered ? "YES" : "NO") << "\n";
+    cout << "Time: " << duration << " sec\n";
 }
@@ -0,0 +1,109 @@
+#ifndef MONOTONE_QUEUE_HPP
+#define MONOTONE_QUEUE_HPP
+
+// Monotone priority queues for non-negative integer keys: a key pushed is
+// never smaller than the last key popped, which holds for Dijkstra's
+// tentative distances. Both are lazy like std::priority_queue (no
+// decrease-key; push again and skip stale entries on pop).
+//
+// DialBuckets  - Dial's circular buckets, one per key value in a window of
+//                max_step + 1 (the largest edge weight). O(1) push, pop
+//                amortized O(1) plus the keys skipped; best for small weights.
+// RadixHeap    - 65 buckets by the highest bit in which a key differs from
+//                the last popped key. O(1) push, pop amortized O(log C) for
+//                keys spanning C; no bound on the weights.
+//
+//     DialBuckets q(10);                 // weights 0..10
+//     q.push(src, 0);
+//     while (!q.empty()) {
+//         auto [d, u] = q.pop();
+//         ...
+//     }
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class DialBuckets {
+public:
+    explicit DialBuckets(uint64_t max_step) : buckets(max_step + 1) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    // Empties the queue and restarts the keys at 0
+    void clear() {
+        for (auto& b : buckets) b.clear();
+        cur = slot = count = 0;
+    }
+
+    // key must be in [last popped, last popped + max_step]
+    void push(int id, uint64_t key) {
+        buckets[key % buckets.size()].push_back(id);
+        count++;
+    }
+
+    // Removes and returns (key, id) with the smallest key
+    std::pair<uint64_t, int> pop() {
+        while (buckets[slot].empty()) {
+            cur++;
+            if (++slot == buckets.size()) slot = 0;
+        }
+        int id = buckets[slot].back();
+        buckets[slot].pop_back();
+        count--;
+        return {cur, id};
+    }
+
+private:
+    std::vector<std::vector<int>> buckets;
+    uint64_t cur = 0; // key of buckets[slot]
+    size_t slot = 0;
+    size_t count = 0;
+};
+
+class RadixHeap {
+public:
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    // Empties the heap and restarts the keys at 0
+    void clear() {
+        for (auto& b : buckets) b.clear();
+        last = count = 0;
+    }
+
+    // key must not be smaller than the last popped key
+    void push(int id, uint64_t key) {
+        buckets[bucket_of(key)].push_back({key, id});
+        count++;
+    }
+
+    // Removes and returns (key, id) with the smallest key
+    std::pair<uint64_t, int> pop() {
+        if (buckets[0].empty()) {
+            // Smallest key is in the first non-empty bucket; make it the new
+            // reference point and spread that bucket over lower ones
+            int i = 1;
+            while (buckets[i].empty()) i++;
+            last = buckets[i][0].first;
+            for (auto& e : buckets[i])
+                if (e.first < last) last = e.first;
+            for (auto& e : buckets[i]) buckets[bucket_of(e.first)].push_back(e);
+            buckets[i].clear();
+        }
+        std::pair<uint64_t, int> e = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        return e;
+    }
+
+private:
+    std::vector<std::pair<uint64_t, int>> buckets[65]; // [0] holds keys == last
+    uint64_t last = 0;
+    size_t count = 0;
+
+    int bucket_of(uint64_t key) const { return key == last ? 0 : 64 - __builtin_clzll(key ^ last); }
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <cstdlib>
 #include <ctime>
+#include <cstring>
+#include <climits>
 
 void sequential_quicksort(std::vector<int>& arr) {
     std::sort(arr.begin(), arr.end());
@@ -72,6 +74,95 @@ void parallel_quicksort(std::vector<int>& arr, int rank, int size, MPI_Comm comm
     }
 }
 
+// Parallel sorting by regular sampling (PSRS).
+// data: rank 0's full input on entry (ignored elsewhere). On return `local`
+// holds this rank's slice of the globally sorted sequence: every key on rank r
+// is <= every key on rank r+1. Nothing is gathered back to rank 0.
+void psrs_sort(std::vector<int>& data, std::vector<int>& local, int N, int rank, int size, MPI_Comm comm) {
+    // 1. Scatter (block distribution, first N%size ranks get one extra)
+    std::vector<int> counts(size), displs(size);
+    for(int r=0; r<size; r++){
+        counts[r] = N/size + (r < N%size ? 1 : 0);
+        displs[r] = r == 0 ? 0 : displs[r-1] + counts[r-1];
+    }
+    std::vector<int> mine(counts[rank]);
+    MPI_Scatterv(rank==0 ? data.data() : nullptr, counts.data(), displs.data(), MPI_INT,
+                 mine.data(), counts[rank], MPI_INT, 0, comm);
+
+    // 2. Local sort
+    std::sort(mine.begin(), mine.end());
+
+    // 3. size regular samples per rank; every rank picks the same size-1 splitters
+    std::vector<int> samples(size, INT_MAX);
+    int n = mine.size();
+    for(int i=0; i<size && n>0; i++)
+        samples[i] = mine[(long long)i*n/size];
+    std::vector<int> all_samples(size*size);
+    MPI_Allgather(samples.data(), size, MPI_INT, all_samples.data(), size, MPI_INT, comm);
+    std::sort(all_samples.begin(), all_samples.end());
+    std::vector<int> splitters(size-1);
+    for(int i=1; i<size; i++)
+        splitters[i-1] = all_samples[i*size + size/2 - 1];
+
+    // 4. Cut the sorted local block at the splitters and exchange buckets
+    std::vector<int> send_counts(size), send_displs(size);
+    int begin = 0;
+    for(int r=0; r<size; r++){
+        int end = r == size-1 ? n
+                : (int)(std::upper_bound(mine.begin()+begin, mine.end(), splitters[r]) - mine.begin());
+        send_displs[r] = begin;
+        send_counts[r] = end - begin;
+        begin = end;
+    }
+    std::vector<int> recv_counts(size), recv_displs(size);
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+    int total = 0;
+    for(int r=0; r<size; r++){
+        recv_displs[r] = total;
+        total += recv_counts[r];
+    }
+    local.resize(total);
+    MPI_Alltoallv(mine.data(), send_counts.data(), send_displs.data(), MPI_INT,
+                  local.data(), recv_counts.data(), recv_displs.data(), MPI_INT, comm);
+
+    // 5. The received buckets are each sorted; merge them pairwise
+    for(int width=1; width<size; width*=2){
+        for(int r=0; r+width<size; r+=2*width){
+            int lo = recv_displs[r];
+            int mid = recv_displs[r+width];
+            int hi = r+2*width < size ? recv_displs[r+2*width] : total;
+            std::inplace_merge(local.begin()+lo, local.begin()+mid, local.begin()+hi);
+        }
+    }
+}
+
+// Global check for a distributed result: each rank is sorted, rank
+// boundaries are ordered (skipping empty ranks) and no key was lost.
+bool check_distributed_sorted(const std::vector<int>& local, long long expected, MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    int ok = std::is_sorted(local.begin(), local.end());
+    // {count, first, last} from every rank
+    long long mine[3] = {(long long)local.size(),
+                         local.empty() ? 0 : local.front(),
+                         local.empty() ? 0 : local.back()};
+    std::vector<long long> all(3*size);
+    MPI_Allgather(mine, 3, MPI_LONG_LONG, all.data(), 3, MPI_LONG_LONG, comm);
+
+    int global_ok;
+    MPI_Allreduce(&ok, &global_ok, 1, MPI_INT, MPI_LAND, comm);
+
+    long long total = 0, prev_last = LLONG_MIN;
+    for(int r=0; r<size; r++){
+        total += all[3*r];
+        if(all[3*r] == 0) continue;
+        if(all[3*r+1] < prev_last) global_ok = 0;
+        prev_last = all[3*r+2];
+    }
+    return global_ok && total == expected;
+}
+
 int main(int argc, char* argv[]) {
     MPI_Init(&argc, &argv);
 
@@ -79,26 +170,58 @@ int main(int argc, char* argv[]) {
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    std::vector<int> arr;
+    // Usage: mpirun -np <p> ./parallel_qsort [--hypercube] [N]
+    bool hypercube = false;
     int N = 1000000;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--hypercube") == 0) hypercube = true;
+        else if(strcmp(argv[i], "--psrs") == 0) hypercube = false;
+        else N = atoi(argv[i]);
+    }
+
+    std::vector<int> arr;
 
     if(rank==0) {
         srand(time(0));
         arr.resize(N);
         for(int i=0;i<N;i++) arr[i] = rand();
     }
+    std::vector<int> input;
+    if(rank==0) input = arr; // kept for the sequential comparison
 
+    MPI_Barrier(MPI_COMM_WORLD);
     double start_time = MPI_Wtime();
 
-    parallel_quicksort(arr, rank, size, MPI_COMM_WORLD);
+    if(hypercube) {
+        parallel_quicksort(arr, rank, size, MPI_COMM_WORLD);
+    } else {
+        std::vector<int> local;
+        psrs_sort(arr, local, N, rank, size, MPI_COMM_WORLD);
+        double end_time = MPI_Wtime();
+
+        double elapsed = end_time - start_time, max_elapsed;
+        MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        int n_local = local.size(), min_local, max_local;
+        MPI_Reduce(&n_local, &min_local, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&n_local, &max_local, 1, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+        bool sorted = check_distributed_sorted(local, N, MPI_COMM_WORLD);
+
+        if(rank==0) {
+            std::cout << "PSRS sample sort completed in " << max_elapsed << " seconds.\n";
+            std::cout << "Keys per rank: min " << min_local << ", max " << max_local
+                      << " (ideal " << N/size << ")\n";
+            std::cout << "Globally sorted? " << (sorted ? "YES" : "NO") << "\n";
+        }
+    }
 
     double end_time = MPI_Wtime();
 
     if(rank==0) {
-        std::cout << "Parallel Quicksort completed in " << end_time-start_time << " seconds.\n";
+        if(hypercube)
+            std::cout << "Parallel Quicksort completed in " << end_time-start_time << " seconds.\n";
 
         // Optional: compare with sequential quicksort
-        std::vector<int> arr_seq = arr;
+        std::vector<int> arr_seq = input;
         start_time = MPI_Wtime();
         sequential_quicksort(arr_seq);
         end_time = MPI_Wtime();
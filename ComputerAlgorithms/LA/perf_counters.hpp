@@ -0,0 +1,154 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+// In-process hardware counters over perf_event_open, the same events we used
+// to collect by hand with `perf stat` (see perfguide.txt):
+// cycles, instructions, branch-misses, L1D / LLC read misses and dTLB misses.
+//
+// Every event is opened on its own, so a PMU that lacks one of them (common in
+// VMs) still reports the rest. When perf is unavailable altogether (non-Linux,
+// perf_event_paranoid too strict, no PMU) the counters print "n/a" and the
+// program runs unchanged.
+//
+//     PerfCounters counters;
+//     counters.start();
+//     ... work ...
+//     counters.stop();
+//     counters.print(cout);
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class PerfCounters {
+public:
+    struct Event {
+        std::string name;
+        uint32_t type;
+        uint64_t config;
+        int fd = -1;
+        uint64_t value = 0;
+        bool scaled = false; // multiplexed: value extrapolated from running time
+    };
+
+    PerfCounters() {
+#ifdef __linux__
+        add("Cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        add("Instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        add("Branch Misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        add("L1D Misses", PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D));
+        add("LLC Misses", PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_LL));
+        add("dTLB Misses", PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_DTLB));
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (auto& e : events)
+            if (e.fd >= 0) close(e.fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const {
+        for (auto& e : events)
+            if (e.fd >= 0) return true;
+        return false;
+    }
+
+    void start() {
+#ifdef __linux__
+        for (auto& e : events) {
+            if (e.fd < 0) continue;
+            ioctl(e.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(e.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        for (auto& e : events) {
+            if (e.fd < 0) continue;
+            ioctl(e.fd, PERF_EVENT_IOC_DISABLE, 0);
+            // value, time_enabled, time_running (PERF_FORMAT_TOTAL_TIME_*)
+            uint64_t buf[3] = {0, 0, 0};
+            if (read(e.fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+                e.value = 0;
+                continue;
+            }
+            e.scaled = buf[2] > 0 && buf[2] < buf[1];
+            e.value = buf[2] > 0 ? (uint64_t)((double)buf[0] * buf[1] / buf[2]) : 0;
+        }
+#endif
+    }
+
+    const std::vector<Event>& results() const { return events; }
+
+    uint64_t get(const std::string& name) const {
+        for (auto& e : events)
+            if (e.name == name && e.fd >= 0) return e.value;
+        return 0;
+    }
+
+    // One "Name: value" line per event, in the same format as Metrics
+    void print(std::ostream& out) const {
+        if (!available()) {
+            out << "HW Counters: n/a (" << reason << ")\n";
+            return;
+        }
+        for (auto& e : events) {
+            out << e.name << ": ";
+            if (e.fd < 0) out << "n/a";
+            else out << e.value << (e.scaled ? " (scaled)" : "");
+            out << "\n";
+        }
+        uint64_t cycles = get("Cycles"), instructions = get("Instructions");
+        if (cycles > 0 && instructions > 0)
+            out << "IPC: " << (double)instructions / cycles << "\n";
+    }
+
+private:
+    std::vector<Event> events;
+    std::string reason = "perf_event_open not supported on this platform";
+
+#ifdef __linux__
+    static uint64_t cacheConfig(uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    void add(const std::string& name, uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // user-space only: works with perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        Event e;
+        e.name = name;
+        e.type = type;
+        e.config = config;
+        e.fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (e.fd < 0) reason = std::string("perf_event_open: ") + strerror(errno);
+        events.push_back(e);
+    }
+#endif
+};
+
+#endif
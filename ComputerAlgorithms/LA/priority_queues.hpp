@@ -0,0 +1,88 @@
+#ifndef PRIORITY_QUEUES_HPP
+#define PRIORITY_QUEUES_HPP
+
+// Priority queue adapters shared by the graph tools (Dijkstra in
+// ShortestPathVisualizer, Prim in MSTComparator). All offer
+//
+//     update(v, k)   v's key is now k (never worse than its previous one)
+//     pop()          removes and returns the smallest (k, v)
+//     clear()        empties the queue, keeping its storage for the next run
+//
+// LAZY_HEAP     binary heap with one entry per update; the stale ones are
+//               popped too and left for the caller to skip
+// DARY_HEAP     indexed 4-ary heap (dary_heap.hpp) lowering keys in place,
+//               so it never holds more than V entries
+// DIAL_BUCKETS  Dial's buckets and the radix heap (monotone_queue.hpp); lazy,
+// RADIX_HEAP    and only for non-negative integer keys that never go below
+//               the last one popped, i.e. Dijkstra with integer weights
+//
+// AUTO_QUEUE lets a tool choose from the graph's weights.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "dary_heap.hpp"
+#include "monotone_queue.hpp"
+
+enum QueueKind { AUTO_QUEUE, LAZY_HEAP, DARY_HEAP, DIAL_BUCKETS, RADIX_HEAP };
+
+// A plain vector kept as a heap rather than std::priority_queue, whose only
+// way to empty is reassignment, dropping the storage between sources
+struct LazyHeapQueue {
+    using P = std::pair<double, int>;
+    std::vector<P> heap;
+    LazyHeapQueue(int) {}
+    bool empty() const { return heap.empty(); }
+    void clear() { heap.clear(); }
+    void update(int v, double k) {
+        heap.push_back({k, v});
+        std::push_heap(heap.begin(), heap.end(), std::greater<P>());
+    }
+    P pop() {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<P>());
+        P top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+};
+
+struct DaryHeapQueue {
+    IndexedDaryHeap<double, 4> heap;
+    DaryHeapQueue(int V) : heap(V) {}
+    bool empty() const { return heap.empty(); }
+    void clear() { heap.clear(); }
+    void update(int v, double k) { heap.push_or_decrease(v, k); }
+    std::pair<double, int> pop() {
+        double k = heap.top_key();
+        return {k, heap.pop()};
+    }
+};
+
+struct DialQueue {
+    DialBuckets q;
+    DialQueue(uint64_t max_weight) : q(max_weight) {}
+    bool empty() const { return q.empty(); }
+    void clear() { q.clear(); }
+    void update(int v, double k) { q.push(v, (uint64_t)k); }
+    std::pair<double, int> pop() {
+        auto [k, v] = q.pop();
+        return {double(k), v};
+    }
+};
+
+struct RadixQueue {
+    RadixHeap q;
+    RadixQueue(int) {}
+    bool empty() const { return q.empty(); }
+    void clear() { q.clear(); }
+    void update(int v, double k) { q.push(v, (uint64_t)k); }
+    std::pair<double, int> pop() {
+        auto [k, v] = q.pop();
+        return {double(k), v};
+    }
+};
+
+#endif
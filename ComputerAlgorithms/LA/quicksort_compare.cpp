@@ -1,73 +1,80 @@
 #include <bits/stdc++.h>
+#include "perf_counters.hpp"
+#include "sortlib.hpp"
+#include "adaptive_sort.hpp"
+#include "select.hpp"
 using namespace std;
 
-enum PivotStrategy { FIRST, RANDOM, MEDIAN3 };
+// ADAPTIVE is not a pivot rule: run-adaptive merge sort, quicksort only for short runs
+enum PivotStrategy { FIRST, RANDOM, MEDIAN3, ADAPTIVE };
 
 // Global counters
-struct Metrics {
-    long long comparisons = 0;
-    long long swaps = 0;
-    long long recursiveCalls = 0;
-};
+using Metrics = sortlib::CountingStats;
 
 Metrics metrics;
-
-// Swap with counting
-void swapCount(int &a, int &b) {
-    swap(a, b);
-    metrics.swaps++;
-}
-
-// Partition function
-int partition(vector<int> &arr, int low, int high, PivotStrategy strategy) {
-    int pivotIndex;
-
-    // --- Pivot selection ---
-    if (strategy == FIRST)
-        pivotIndex = low;
-    else if (strategy == RANDOM)
-        pivotIndex = low + rand() % (high - low + 1);
-    else { // MEDIAN OF THREE
-        int mid = (low + high) / 2;
-        int a = arr[low], b = arr[mid], c = arr[high];
-        // Find median of (a,b,c)
-        if ((a > b) != (a > c)) pivotIndex = low;
-        else if ((b > a) != (b > c)) pivotIndex = mid;
-        else pivotIndex = high;
-    }
-
-    swapCount(arr[pivotIndex], arr[high]);
-    int pivot = arr[high];
-
-    int i = low - 1;
-    for (int j = low; j < high; j++) {
-        metrics.comparisons++;
-        if (arr[j] < pivot) {
-            i++;
-            swapCount(arr[i], arr[j]);
-        }
-    }
-    swapCount(arr[i + 1], arr[high]);
-    return i + 1;
+PerfCounters counters; // hardware events (n/a if perf is unavailable)
+
+// Plain quicksort (no cutoff, no heapsort fallback) with Lomuto partition;
+// only the pivot varies, so each rule's worst case shows in the counts
+template <class Pivot>
+void quickSortWith(vector<int> &arr) {
+    sortlib::quickSort(arr.begin(), arr.end(), less<int>(), metrics, Pivot(),
+                       sortlib::LomutoPartition(), sortlib::InsertionBase<1>(), sortlib::UNLIMITED_DEPTH);
 }
 
-// QuickSort recursive function
-void quickSort(vector<int> &arr, int low, int high, PivotStrategy strategy) {
-    if (low < high) {
-        metrics.recursiveCalls++;
-        int pi = partition(arr, low, high, strategy);
-        quickSort(arr, low, pi - 1, strategy);
-        quickSort(arr, pi + 1, high, strategy);
-    }
+void quickSort(vector<int> &arr, PivotStrategy strategy) {
+    if (strategy == FIRST) quickSortWith<sortlib::FirstPivot>(arr);
+    else if (strategy == RANDOM) quickSortWith<sortlib::RandomPivot>(arr);
+    else if (strategy == MEDIAN3) quickSortWith<sortlib::Median3Pivot>(arr);
+    else sortlib::adaptiveSort(arr.begin(), arr.end(), less<int>(), metrics);
 }
 
 void runExperiment(vector<int> arr, PivotStrategy strategy, string name) {
     metrics = {}; // reset
-    quickSort(arr, 0, arr.size() - 1, strategy);
+    counters.start();
+    quickSort(arr, strategy);
+    counters.stop();
     cout << "\n--- " << name << " ---\n";
     cout << "Comparisons: " << metrics.comparisons << "\n";
     cout << "Swaps: " << metrics.swaps << "\n";
     cout << "Recursive Calls: " << metrics.recursiveCalls << "\n";
+    counters.print(cout);
+}
+
+// Median, 99th percentile and top 10 by introselect instead of a full sort
+template <class Pivot>
+void runSelection(vector<int> arr, string name) {
+    metrics = {};
+    counters.start();
+    size_t n = arr.size(), k = min<size_t>(10, n);
+    sortlib::nthElement(arr.begin(), arr.begin() + n / 2, arr.end(), less<int>(), metrics, Pivot());
+    int median = arr[n / 2];
+    sortlib::nthElement(arr.begin(), arr.begin() + n * 99 / 100, arr.end(), less<int>(), metrics, Pivot());
+    int p99 = arr[n * 99 / 100];
+    sortlib::topK(arr.begin(), arr.end(), k, less<int>(), metrics, Pivot());
+    counters.stop();
+    cout << "\n--- " << name << " ---\n";
+    cout << "Median: " << median << ", P99: " << p99 << ", Top " << k << ":";
+    for (size_t i = 0; i < k; i++) cout << " " << arr[i];
+    cout << "\n";
+    cout << "Comparisons: " << metrics.comparisons << "\n";
+    cout << "Swaps: " << metrics.swaps << "\n";
+    cout << "Recursive Calls: " << metrics.recursiveCalls << "\n";
+    counters.print(cout);
+}
+
+void runSelections(const vector<int> &arr) {
+    runSelection<sortlib::FirstPivot>(arr, "Select, Pivot: First Element");
+    runSelection<sortlib::RandomPivot>(arr, "Select, Pivot: Random Element");
+    runSelection<sortlib::Median3Pivot>(arr, "Select, Pivot: Median of Three");
+    runSelection<sortlib::MedianOfMediansPivot>(arr, "Select, Pivot: Median of Medians");
+
+    auto start = chrono::high_resolution_clock::now();
+    vector<int> best = sortlib::parallelTopK(arr.begin(), arr.end(), 10);
+    auto end = chrono::high_resolution_clock::now();
+    cout << "\n--- Parallel Top 10 (per-thread heaps) ---\n";
+    for (int x : best) cout << x << " ";
+    cout << "\nTime: " << chrono::duration<double, micro>(end - start).count() << " us\n";
 }
 
 int main() {
@@ -93,21 +100,31 @@ int main() {
     runExperiment(randomArr, FIRST, "Pivot: First Element");
     runExperiment(randomArr, RANDOM, "Pivot: Random Element");
     runExperiment(randomArr, MEDIAN3, "Pivot: Median of Three");
+    runExperiment(randomArr, ADAPTIVE, "Adaptive Runs (powersort)");
 
     cout << "\n==== Sorted Input ====\n";
     runExperiment(sortedArr, FIRST, "Pivot: First Element");
     runExperiment(sortedArr, RANDOM, "Pivot: Random Element");
     runExperiment(sortedArr, MEDIAN3, "Pivot: Median of Three");
+    runExperiment(sortedArr, ADAPTIVE, "Adaptive Runs (powersort)");
 
     cout << "\n==== Reverse Sorted Input ====\n";
     runExperiment(reverseArr, FIRST, "Pivot: First Element");
     runExperiment(reverseArr, RANDOM, "Pivot: Random Element");
     runExperiment(reverseArr, MEDIAN3, "Pivot: Median of Three");
+    runExperiment(reverseArr, ADAPTIVE, "Adaptive Runs (powersort)");
 
     cout << "\n==== Few Unique Elements ====\n";
     runExperiment(fewUniqueArr, FIRST, "Pivot: First Element");
     runExperiment(fewUniqueArr, RANDOM, "Pivot: Random Element");
     runExperiment(fewUniqueArr, MEDIAN3, "Pivot: Median of Three");
+    runExperiment(fewUniqueArr, ADAPTIVE, "Adaptive Runs (powersort)");
+
+    cout << "\n==== Selection: Random Input ====\n";
+    runSelections(randomArr);
+
+    cout << "\n==== Selection: Sorted Input ====\n";
+    runSelections(sortedArr);
 
     return 0;
 }
@@ -0,0 +1,166 @@
+#ifndef SELECT_HPP
+#define SELECT_HPP
+
+// Selection on top of the sortlib engine: when only a median, a percentile or
+// the best k keys are needed there is no reason to sort everything.
+//
+//   nthElement   introselect: same pivot policies as quicksort_compare.cpp,
+//                switching to median-of-medians after 2*log2(n) bad rounds,
+//                so the worst case stays O(n)
+//   partialSort  smallest k in order: nthElement + sort of the prefix
+//   topK         largest k in descending order at the front of the range
+//   parallelTopK copy of the largest k, input untouched; one bounded heap per
+//                thread (OpenMP), merged at the end
+//
+//     sortlib::nthElement(v.begin(), v.begin() + v.size() / 2, v.end()); // median
+//     auto best = sortlib::parallelTopK(v.begin(), v.end(), 1000);
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "sortlib.hpp"
+
+namespace sortlib {
+
+template <class It, class Cmp, class Stats, class Pivot>
+void nthElement(It first, It nth, It last, Cmp cmp, Stats& stats, Pivot pivot);
+
+// Median of the medians of groups of five: a pivot that is guaranteed to
+// leave at least ~30% of the range on either side
+struct MedianOfMediansPivot {
+    template <class It, class Cmp>
+    It operator()(It first, It last, Cmp& cmp) const {
+        NoStats none;
+        auto n = last - first;
+        if (n <= 5) {
+            insertionSort(first, last, cmp, none);
+            return first + (n - 1) / 2;
+        }
+        // group medians are gathered at the front
+        It store = first;
+        for (It g = first; g < last; g += std::min<decltype(n)>(5, last - g)) {
+            It ge = g + std::min<decltype(n)>(5, last - g);
+            insertionSort(g, ge, cmp, none);
+            std::iter_swap(store++, g + (ge - g - 1) / 2);
+        }
+        It mid = first + (store - first - 1) / 2;
+        nthElement(first, mid, store, cmp, none, MedianOfMediansPivot());
+        return mid;
+    }
+};
+
+template <class It, class Cmp, class Stats, class Pivot>
+void nthElement(It first, It nth, It last, Cmp cmp, Stats& stats, Pivot pivot) {
+    if (nth >= last) return;
+    int budget = 0;
+    for (auto n = last - first; n > 1; n >>= 1) budget += 2;
+
+    while (last - first > 16) {
+        stats.call();
+        It p = budget-- > 0 ? pivot(first, last, cmp) : MedianOfMediansPivot()(first, last, cmp);
+        std::pair<It, It> eq = ThreeWayPartition()(first, last, p, cmp, stats);
+        if (nth < eq.first) last = eq.first;
+        else if (nth >= eq.second) first = eq.second;
+        else return; // nth landed in the block equal to the pivot
+    }
+    insertionSort(first, last, cmp, stats);
+}
+
+template <class It, class Cmp = std::less<>>
+void nthElement(It first, It nth, It last, Cmp cmp = Cmp()) {
+    NoStats stats;
+    nthElement(first, nth, last, cmp, stats, Median3Pivot());
+}
+
+// [first, middle) receives the smallest middle-first elements in order
+template <class It, class Cmp, class Stats, class Pivot>
+void partialSort(It first, It middle, It last, Cmp cmp, Stats& stats, Pivot pivot) {
+    if (middle <= first) return;
+    nthElement(first, middle - 1, last, cmp, stats, pivot);
+    quickSort(first, middle - 1, cmp, stats, pivot, ThreeWayPartition(), InsertionBase<16>());
+}
+
+template <class It, class Cmp = std::less<>>
+void partialSort(It first, It middle, It last, Cmp cmp = Cmp()) {
+    NoStats stats;
+    partialSort(first, middle, last, cmp, stats, Median3Pivot());
+}
+
+// Reversed ordering as a named type so it can be handed to the policies
+template <class Cmp>
+struct Reversed {
+    Cmp cmp;
+    template <class A, class B>
+    bool operator()(const A& a, const B& b) { return cmp(b, a); }
+};
+
+// [first, first+k) receives the k largest elements, largest first
+template <class It, class Cmp, class Stats, class Pivot>
+void topK(It first, It last, size_t k, Cmp cmp, Stats& stats, Pivot pivot) {
+    k = std::min<size_t>(k, last - first);
+    partialSort(first, first + k, last, Reversed<Cmp>{cmp}, stats, pivot);
+}
+
+template <class It, class Cmp = std::less<>>
+void topK(It first, It last, size_t k, Cmp cmp = Cmp()) {
+    NoStats stats;
+    topK(first, last, k, cmp, stats, Median3Pivot());
+}
+
+// Largest k elements of a read-only range, largest first. Each thread keeps a
+// k-element heap whose top is its current k-th best, so most elements cost a
+// single comparison; the per-thread heaps are merged with topK.
+template <class It, class Cmp = std::less<>>
+std::vector<typename std::iterator_traits<It>::value_type>
+parallelTopK(It first, It last, size_t k, Cmp cmp = Cmp()) {
+    using V = typename std::iterator_traits<It>::value_type;
+    long long n = last - first;
+    k = std::min<size_t>(k, n);
+    if (k == 0) return {};
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    std::vector<std::vector<V>> heaps(threads);
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        std::vector<V>& h = heaps[t];
+        h.reserve(k);
+        Cmp better = cmp;               // per-thread copies of the comparator
+        Reversed<Cmp> order{cmp};       // heap order: worst kept element on top
+        #pragma omp for schedule(static)
+        for (long long i = 0; i < n; i++) {
+            const V& x = first[i];
+            if (h.size() < k) {
+                h.push_back(x);
+                std::push_heap(h.begin(), h.end(), order);
+            } else if (better(h.front(), x)) {
+                std::pop_heap(h.begin(), h.end(), order);
+                h.back() = x;
+                std::push_heap(h.begin(), h.end(), order);
+            }
+        }
+    }
+
+    std::vector<V> all;
+    for (auto& h : heaps) all.insert(all.end(), h.begin(), h.end());
+    topK(all.begin(), all.end(), k, cmp);
+    all.resize(k);
+    return all;
+}
+
+} // namespace sortlib
+
+#endif
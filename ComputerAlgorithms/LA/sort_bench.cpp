@@ -0,0 +1,274 @@
+#include <bits/stdc++.h>
+#include "sortlib.hpp"
+#include "adaptive_sort.hpp"
+#include "stable_sort.hpp"
+using namespace std;
+
+// One benchmark for every in-memory sort engine in this directory.
+// For each (size, distribution, engine) the input is generated once, then
+// sorted from a fresh copy WARMUP + REPS times; only the REPS runs are timed.
+// Results go out as CSV (median / p10 / p90 / min seconds and throughput),
+// and every timed run is checked with is_sorted and a checksum.
+//
+//   g++ -O3 -march=native -fopenmp sort_bench.cpp -o sort_bench
+//   ./sort_bench --sizes 1e3,1e5,1e7 --engines quick_3way,adaptive --out bench.csv
+//
+// --check is the regression run for the pathological inputs (organ pipe,
+// sawtooth, killer, ...): one run per engine at 2^20 elements unless --sizes
+// is given, failing if any engine takes more than CHECK_SLOWDOWN times as
+// long as std::sort on the same input.
+//
+//   ./sort_bench --check --out /dev/null
+
+// ----------------- Engines -----------------
+struct Engine {
+    string name;
+    function<void(vector<int>&)> run;
+};
+
+sortlib::StableSorter<int> stableSorter; // scratch reused across runs
+
+vector<Engine> engines() {
+    return {
+        {"std_sort", [](vector<int>& a) { sort(a.begin(), a.end()); }},
+        {"std_stable_sort", [](vector<int>& a) { stable_sort(a.begin(), a.end()); }},
+        // hybrid_sort.cpp defaults: last pivot, Lomuto, insertion leaves of 10
+        {"hybrid", [](vector<int>& a) {
+             sortlib::quickSort<sortlib::LastPivot, sortlib::LomutoPartition,
+                                sortlib::InsertionBase<10>>(a.begin(), a.end());
+         }},
+        {"quick_median3", [](vector<int>& a) {
+             sortlib::quickSort<sortlib::Median3Pivot, sortlib::LomutoPartition,
+                                sortlib::InsertionBase<16>>(a.begin(), a.end());
+         }},
+        // the configuration external_sort.cpp uses for its runs; median of
+        // three alone would be O(n^2) on organ-pipe inputs, the depth limit
+        // hands those ranges to heapsort
+        {"quick_3way", [](vector<int>& a) {
+             sortlib::quickSort<sortlib::Median3Pivot, sortlib::ThreeWayPartition,
+                                sortlib::NetworkBase<32>>(a.begin(), a.end());
+         }},
+        {"adaptive", [](vector<int>& a) { sortlib::adaptiveSort(a.begin(), a.end()); }},
+        {"block_merge", [](vector<int>& a) { sortnet::blockMergeSort(a.data(), a.size()); }},
+        {"parallel_stable", [](vector<int>& a) { stableSorter.sort(a.begin(), a.end()); }},
+    };
+}
+
+// ----------------- Input distributions -----------------
+// Zipf(s = 1) over `universe` ranks by inverse CDF
+vector<int> zipfInput(size_t n, mt19937_64& rng) {
+    size_t universe = min<size_t>(max<size_t>(n, 1), 1000000);
+    vector<double> cdf(universe);
+    double sum = 0;
+    for (size_t r = 0; r < universe; r++) cdf[r] = (sum += 1.0 / (r + 1));
+    uniform_real_distribution<double> u(0, sum);
+    vector<int> a(n);
+    for (size_t i = 0; i < n; i++) a[i] = int(lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin());
+    return a;
+}
+
+// McIlroy's adversary ("A killer adversary for quicksort", 1999): the values
+// are decided lazily while the quick_3way engine sorts, always in the way
+// that keeps its partitions lopsided, so every range runs into the depth
+// limit. Also reaches the quicksort fallback of adaptiveSort, since the
+// result has no long natural runs.
+vector<int> killerInput(size_t n) {
+    const int gas = int(n); // not decided yet; compares above every decided value
+    vector<int> val(n, gas), idx(n);
+    iota(idx.begin(), idx.end(), 0);
+    int solid = 0, candidate = -1;
+    auto cmp = [&](int x, int y) {
+        if (val[x] == gas && val[y] == gas) val[x == candidate ? x : y] = solid++;
+        if (val[x] == gas) candidate = x;
+        else if (val[y] == gas) candidate = y;
+        return val[x] < val[y];
+    };
+    sortlib::NoStats stats;
+    sortlib::quickSort(idx.begin(), idx.end(), cmp, stats, sortlib::Median3Pivot(), sortlib::ThreeWayPartition(),
+                       sortlib::NetworkBase<32>());
+    return val;
+}
+
+const vector<string> DISTRIBUTIONS = {"random", "sorted", "reverse", "few_unique", "organ_pipe",
+                                      "sawtooth", "zipf", "nearly_sorted", "killer"};
+
+vector<int> makeInput(const string& dist, size_t n, uint64_t seed) {
+    mt19937_64 rng(seed);
+    vector<int> a(n);
+    if (dist == "random") {
+        for (auto& x : a) x = int(rng());
+    } else if (dist == "sorted" || dist == "reverse" || dist == "nearly_sorted") {
+        for (size_t i = 0; i < n; i++) a[i] = int(i);
+        if (dist == "reverse") reverse(a.begin(), a.end());
+        if (dist == "nearly_sorted") // 1% of the positions swapped
+            for (size_t i = 0; i < n / 100; i++) swap(a[rng() % n], a[rng() % n]);
+    } else if (dist == "few_unique") {
+        for (auto& x : a) x = int(rng() % 16);
+    } else if (dist == "organ_pipe") {
+        for (size_t i = 0; i < n; i++) a[i] = int(i < n / 2 ? i : n - i);
+    } else if (dist == "sawtooth") {
+        size_t period = max<size_t>(n / 32, 1); // 32 ascending teeth
+        for (size_t i = 0; i < n; i++) a[i] = int(i % period);
+    } else if (dist == "zipf") {
+        a = zipfInput(n, rng);
+    } else if (dist == "killer") {
+        a = killerInput(n);
+    }
+    return a;
+}
+
+// ----------------- Measurement -----------------
+struct Config {
+    vector<size_t> sizes = {1000, 10000, 100000, 1000000, 10000000};
+    vector<string> engines, distributions;
+    int reps = 5;
+    int warmup = 1;
+    bool check = false;
+    string out;
+    uint64_t seed = 12345;
+};
+
+const double CHECK_SLOWDOWN = 20;
+
+// Nearest-rank percentile of sorted samples
+double percentile(const vector<double>& sorted, double p) {
+    size_t idx = (size_t)ceil(p / 100.0 * sorted.size());
+    return sorted[min(sorted.size() - 1, idx == 0 ? 0 : idx - 1)];
+}
+
+long long checksum(const vector<int>& a) {
+    long long s = 0;
+    for (int x : a) s += x;
+    return s;
+}
+
+// Returns false if some run produced a wrong result; median gets the median time
+bool benchmark(const Engine& e, const string& dist, const vector<int>& input, const Config& cfg, ostream& csv,
+               double& median) {
+    size_t n = input.size();
+    csv << e.name << "," << dist << "," << n << ",";
+
+    long long expected = checksum(input);
+    vector<int> work;
+    vector<double> times;
+    bool ok = true;
+    for (int r = 0; r < cfg.warmup + cfg.reps; r++) {
+        work = input; // copy is not timed
+        auto start = chrono::steady_clock::now();
+        e.run(work);
+        double t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (!is_sorted(work.begin(), work.end()) || checksum(work) != expected) ok = false;
+        if (r >= cfg.warmup) times.push_back(t);
+    }
+
+    sort(times.begin(), times.end());
+    median = percentile(times, 50);
+    csv << times.size() << "," << median << "," << percentile(times, 10) << ","
+        << percentile(times, 90) << "," << times.front() << ","
+        << (median > 0 ? n / median / 1e6 : 0) << "," << (ok ? "ok" : "FAILED") << "\n";
+    csv.flush();
+    return ok;
+}
+
+// ----------------- Command line -----------------
+vector<string> splitList(const string& s) {
+    vector<string> items;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ','))
+        if (!item.empty()) items.push_back(item);
+    return items;
+}
+
+void usage(const char* prog) {
+    cerr << "Usage: " << prog << " [--sizes N,N,...] [--engines a,b,...] [--dists a,b,...]"
+         << " [--reps R] [--warmup W] [--seed S] [--out FILE] [--check]\n";
+    cerr << "Sizes accept scientific notation (1e3 .. 1e9).\n";
+    cerr << "Engines:";
+    for (auto& e : engines()) cerr << " " << e.name;
+    cerr << "\nDistributions:";
+    for (auto& d : DISTRIBUTIONS) cerr << " " << d;
+    cerr << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            cfg.sizes.clear();
+            for (auto& s : splitList(argv[++i])) cfg.sizes.push_back((size_t)stod(s));
+        } else if (arg == "--engines" && hasValue) cfg.engines = splitList(argv[++i]);
+        else if (arg == "--dists" && hasValue) cfg.distributions = splitList(argv[++i]);
+        else if (arg == "--reps" && hasValue) cfg.reps = max(1, atoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue) cfg.warmup = max(0, atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) cfg.seed = stoull(argv[++i]);
+        else if (arg == "--out" && hasValue) cfg.out = argv[++i];
+        else if (arg == "--check") cfg.check = true;
+        else { usage(argv[0]); return 1; }
+    }
+    if (cfg.check) {
+        bool sizesGiven = false;
+        for (int i = 1; i < argc; i++) sizesGiven |= string(argv[i]) == "--sizes";
+        if (!sizesGiven) cfg.sizes = {1 << 20};
+        cfg.reps = 1;
+        cfg.warmup = 0;
+    }
+
+    vector<Engine> selected;
+    for (auto& e : engines())
+        if (cfg.engines.empty() || find(cfg.engines.begin(), cfg.engines.end(), e.name) != cfg.engines.end())
+            selected.push_back(e);
+    if (cfg.distributions.empty()) cfg.distributions = DISTRIBUTIONS;
+    for (auto& d : cfg.distributions)
+        if (find(DISTRIBUTIONS.begin(), DISTRIBUTIONS.end(), d) == DISTRIBUTIONS.end()) {
+            cerr << "Unknown distribution: " << d << "\n";
+            usage(argv[0]);
+            return 1;
+        }
+    if (selected.empty()) {
+        cerr << "No matching engines\n";
+        usage(argv[0]);
+        return 1;
+    }
+
+    ofstream fout;
+    if (!cfg.out.empty()) {
+        fout.open(cfg.out);
+        if (!fout) {
+            cerr << "Cannot open " << cfg.out << "\n";
+            return 1;
+        }
+    }
+    ostream& csv = cfg.out.empty() ? cout : fout;
+    csv << "engine,distribution,n,reps,median_s,p10_s,p90_s,min_s,melems_per_s,status\n";
+
+    bool allOk = true, allFast = true;
+    for (size_t n : cfg.sizes) {
+        for (auto& dist : cfg.distributions) {
+            vector<int> input = makeInput(dist, n, cfg.seed);
+            double baseline = 0;
+            if (cfg.check) {
+                vector<int> work = input;
+                auto start = chrono::steady_clock::now();
+                sort(work.begin(), work.end());
+                baseline = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            }
+            for (auto& e : selected) {
+                cerr << "n=" << n << " " << dist << " " << e.name << "\n";
+                double median;
+                allOk &= benchmark(e, dist, input, cfg, csv, median);
+                // 10 ms of slack so tiny inputs are not judged on timer noise
+                if (cfg.check && median > CHECK_SLOWDOWN * baseline + 0.01) {
+                    cerr << e.name << " on " << dist << " (n=" << n << ") took " << median << " s, std::sort "
+                         << baseline << " s\n";
+                    allFast = false;
+                }
+            }
+        }
+    }
+    if (!allOk) cerr << "Some engine produced unsorted output (see status column)\n";
+    if (!allFast) cerr << "Some engine was more than " << CHECK_SLOWDOWN << "x slower than std::sort\n";
+    return allOk ? (allFast ? 0 : 3) : 2;
+}
@@ -0,0 +1,350 @@
+#ifndef SORT_NETWORK_HPP
+#define SORT_NETWORK_HPP
+
+// Bitonic sorting networks for small int/float blocks (8, 16, 32, 64 elements)
+// with AVX2 and AVX-512 kernels, a scalar network fallback and a vectorized
+// merge for combining sorted blocks. The ISA is picked once at runtime, so the
+// file builds with a plain `g++ -O2` and still uses AVX-512 where available.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SORTNET_X86 1
+#endif
+
+namespace sortnet {
+
+enum SimdLevel { SCALAR, AVX2, AVX512 };
+
+inline SimdLevel detectSimd() {
+#ifdef SORTNET_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return AVX512;
+    if (__builtin_cpu_supports("avx2")) return AVX2;
+#endif
+    return SCALAR;
+}
+
+// Detected once; callers may lower it (e.g. to compare against the scalar path)
+inline SimdLevel& simdLevel() {
+    static SimdLevel level = detectSimd();
+    return level;
+}
+
+inline const char* simdName(SimdLevel level) {
+    switch (level) {
+        case AVX512: return "AVX-512";
+        case AVX2:   return "AVX2";
+        default:     return "scalar";
+    }
+}
+
+// ----------------- Scalar network -----------------
+// Same comparator sequence as the SIMD kernels, written with branch-free
+// min/max so the compiler can keep it in registers.
+template <class T>
+inline void scalarBitonicSort(T* a, int n) {
+    for (int k = 2; k <= n; k <<= 1) {
+        for (int j = k >> 1; j > 0; j >>= 1) {
+            for (int i = 0; i < n; i++) {
+                int l = i ^ j;
+                if (l <= i) continue;
+                T x = a[i], y = a[l];
+                T lo = std::min(x, y), hi = std::max(x, y);
+                bool asc = (i & k) == 0;
+                a[i] = asc ? lo : hi;
+                a[l] = asc ? hi : lo;
+            }
+        }
+    }
+}
+
+template <class T>
+inline void scalarMerge(const T* a, size_t na, const T* b, size_t nb, T* out) {
+    size_t i = 0, j = 0, o = 0;
+    while (i < na && j < nb) out[o++] = (b[j] < a[i]) ? b[j++] : a[i++];
+    while (i < na) out[o++] = a[i++];
+    while (j < nb) out[o++] = b[j++];
+}
+
+#ifdef SORTNET_X86
+
+// Compile-time description of one bitonic stage on a W-lane register:
+// lane i is compared with lane i^J and keeps the max when it is the upper
+// lane of an ascending pair (or the lower lane of a descending one).
+template <int W, int K, int J>
+struct Stage {
+    static constexpr int partner(int i) { return i ^ J; }
+    static constexpr bool takeMax(int i) {
+        return ((i & J) != 0) != ((i & K) != 0 && K < W);
+    }
+    static constexpr unsigned maxMask() {
+        unsigned m = 0;
+        for (int i = 0; i < W; i++)
+            if (takeMax(i)) m |= 1u << i;
+        return m;
+    }
+};
+
+#define SORTNET_INLINE inline __attribute__((always_inline))
+
+// ----------------- AVX2 (8 lanes) -----------------
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+template <int K, int J>
+inline __m256i avx2Idx() {
+    using S = Stage<8, K, J>;
+    return _mm256_setr_epi32(S::partner(0), S::partner(1), S::partner(2), S::partner(3),
+                             S::partner(4), S::partner(5), S::partner(6), S::partner(7));
+}
+
+struct Avx2Int {
+    using T = int;
+    using V = __m256i;
+    static constexpr int W = 8;
+    static SORTNET_INLINE V load(const T* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static SORTNET_INLINE void store(T* p, V v) { _mm256_storeu_si256((__m256i*)p, v); }
+    static SORTNET_INLINE V min(V a, V b) { return _mm256_min_epi32(a, b); }
+    static SORTNET_INLINE V max(V a, V b) { return _mm256_max_epi32(a, b); }
+    static SORTNET_INLINE V reverse(V v) {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+    template <int K, int J>
+    static SORTNET_INLINE V stage(V v) {
+        V p = _mm256_permutevar8x32_epi32(v, avx2Idx<K, J>());
+        constexpr int mask = Stage<8, K, J>::maxMask();
+        return _mm256_blend_epi32(min(v, p), max(v, p), mask);
+    }
+    static SORTNET_INLINE V mergeReg(V v) {
+        v = stage<8, 4>(v); v = stage<8, 2>(v); return stage<8, 1>(v);
+    }
+    static SORTNET_INLINE V sortReg(V v) {
+        v = stage<2, 1>(v);
+        v = stage<4, 2>(v); v = stage<4, 1>(v);
+        return mergeReg(v);
+    }
+};
+
+struct Avx2Float {
+    using T = float;
+    using V = __m256;
+    static constexpr int W = 8;
+    static SORTNET_INLINE V load(const T* p) { return _mm256_loadu_ps(p); }
+    static SORTNET_INLINE void store(T* p, V v) { _mm256_storeu_ps(p, v); }
+    static SORTNET_INLINE V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static SORTNET_INLINE V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static SORTNET_INLINE V reverse(V v) {
+        return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+    template <int K, int J>
+    static SORTNET_INLINE V stage(V v) {
+        V p = _mm256_permutevar8x32_ps(v, avx2Idx<K, J>());
+        constexpr int mask = Stage<8, K, J>::maxMask();
+        return _mm256_blend_ps(min(v, p), max(v, p), mask);
+    }
+    static SORTNET_INLINE V mergeReg(V v) {
+        v = stage<8, 4>(v); v = stage<8, 2>(v); return stage<8, 1>(v);
+    }
+    static SORTNET_INLINE V sortReg(V v) {
+        v = stage<2, 1>(v);
+        v = stage<4, 2>(v); v = stage<4, 1>(v);
+        return mergeReg(v);
+    }
+};
+
+namespace avx2 {
+#include "sort_network_kernel.inc"
+}
+
+template <class T> struct Avx2Ops;
+template <> struct Avx2Ops<int> { using type = Avx2Int; };
+template <> struct Avx2Ops<float> { using type = Avx2Float; };
+
+template <class T>
+void sortBlockAvx2(T* a, int n) {
+    using Ops = typename Avx2Ops<T>::type;
+    switch (n) {
+        case 8:  avx2::sortBlockWith<Ops, 1>(a); break;
+        case 16: avx2::sortBlockWith<Ops, 2>(a); break;
+        case 32: avx2::sortBlockWith<Ops, 4>(a); break;
+        case 64: avx2::sortBlockWith<Ops, 8>(a); break;
+    }
+}
+
+template <class T>
+void mergeAvx2(const T* a, size_t na, const T* b, size_t nb, T* out) {
+    avx2::mergeWith<typename Avx2Ops<T>::type>(a, na, b, nb, out);
+}
+
+#pragma GCC pop_options
+
+// ----------------- AVX-512 (16 lanes) -----------------
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// GCC 12 flags the _mm512_undefined_* placeholders inside the intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+template <int K, int J>
+inline __m512i avx512Idx() {
+    using S = Stage<16, K, J>;
+    return _mm512_setr_epi32(S::partner(0), S::partner(1), S::partner(2), S::partner(3),
+                             S::partner(4), S::partner(5), S::partner(6), S::partner(7),
+                             S::partner(8), S::partner(9), S::partner(10), S::partner(11),
+                             S::partner(12), S::partner(13), S::partner(14), S::partner(15));
+}
+
+inline __m512i avx512ReverseIdx() {
+    return _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+}
+
+struct Avx512Int {
+    using T = int;
+    using V = __m512i;
+    static constexpr int W = 16;
+    static SORTNET_INLINE V load(const T* p) { return _mm512_loadu_si512(p); }
+    static SORTNET_INLINE void store(T* p, V v) { _mm512_storeu_si512(p, v); }
+    static SORTNET_INLINE V min(V a, V b) { return _mm512_min_epi32(a, b); }
+    static SORTNET_INLINE V max(V a, V b) { return _mm512_max_epi32(a, b); }
+    static SORTNET_INLINE V reverse(V v) { return _mm512_permutexvar_epi32(avx512ReverseIdx(), v); }
+    template <int K, int J>
+    static SORTNET_INLINE V stage(V v) {
+        V p = _mm512_permutexvar_epi32(avx512Idx<K, J>(), v);
+        return _mm512_mask_blend_epi32((__mmask16)Stage<16, K, J>::maxMask(), min(v, p), max(v, p));
+    }
+    static SORTNET_INLINE V mergeReg(V v) {
+        v = stage<16, 8>(v); v = stage<16, 4>(v); v = stage<16, 2>(v); return stage<16, 1>(v);
+    }
+    static SORTNET_INLINE V sortReg(V v) {
+        v = stage<2, 1>(v);
+        v = stage<4, 2>(v); v = stage<4, 1>(v);
+        v = stage<8, 4>(v); v = stage<8, 2>(v); v = stage<8, 1>(v);
+        return mergeReg(v);
+    }
+};
+
+struct Avx512Float {
+    using T = float;
+    using V = __m512;
+    static constexpr int W = 16;
+    static SORTNET_INLINE V load(const T* p) { return _mm512_loadu_ps(p); }
+    static SORTNET_INLINE void store(T* p, V v) { _mm512_storeu_ps(p, v); }
+    static SORTNET_INLINE V min(V a, V b) { return _mm512_min_ps(a, b); }
+    static SORTNET_INLINE V max(V a, V b) { return _mm512_max_ps(a, b); }
+    static SORTNET_INLINE V reverse(V v) { return _mm512_permutexvar_ps(avx512ReverseIdx(), v); }
+    template <int K, int J>
+    static SORTNET_INLINE V stage(V v) {
+        V p = _mm512_permutexvar_ps(avx512Idx<K, J>(), v);
+        return _mm512_mask_blend_ps((__mmask16)Stage<16, K, J>::maxMask(), min(v, p), max(v, p));
+    }
+    static SORTNET_INLINE V mergeReg(V v) {
+        v = stage<16, 8>(v); v = stage<16, 4>(v); v = stage<16, 2>(v); return stage<16, 1>(v);
+    }
+    static SORTNET_INLINE V sortReg(V v) {
+        v = stage<2, 1>(v);
+        v = stage<4, 2>(v); v = stage<4, 1>(v);
+        v = stage<8, 4>(v); v = stage<8, 2>(v); v = stage<8, 1>(v);
+        return mergeReg(v);
+    }
+};
+
+namespace avx512 {
+#include "sort_network_kernel.inc"
+}
+
+template <class T> struct Avx512Ops;
+template <> struct Avx512Ops<int> { using type = Avx512Int; };
+template <> struct Avx512Ops<float> { using type = Avx512Float; };
+
+// 8-element blocks do not fill a zmm register; those stay on the AVX2 kernel
+template <class T>
+void sortBlockAvx512(T* a, int n) {
+    using Ops = typename Avx512Ops<T>::type;
+    switch (n) {
+        case 16: avx512::sortBlockWith<Ops, 1>(a); break;
+        case 32: avx512::sortBlockWith<Ops, 2>(a); break;
+        case 64: avx512::sortBlockWith<Ops, 4>(a); break;
+    }
+}
+
+template <class T>
+void mergeAvx512(const T* a, size_t na, const T* b, size_t nb, T* out) {
+    avx512::mergeWith<typename Avx512Ops<T>::type>(a, na, b, nb, out);
+}
+
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+#undef SORTNET_INLINE
+
+#endif // SORTNET_X86
+
+// ----------------- Dispatching API -----------------
+
+// Sort exactly n elements in place, n in {8, 16, 32, 64}
+template <class T>
+inline void sortBlock(T* a, int n) {
+#ifdef SORTNET_X86
+    SimdLevel level = simdLevel();
+    if (level == AVX512 && n >= 16) { sortBlockAvx512(a, n); return; }
+    if (level >= AVX2) { sortBlockAvx2(a, n); return; }
+#endif
+    scalarBitonicSort(a, n);
+}
+
+// Sort any n <= 64 by padding up to the next network size with +max sentinels
+template <class T>
+inline void sortSmall(T* a, int n) {
+    if (n <= 1) return;
+    int block = n <= 8 ? 8 : n <= 16 ? 16 : n <= 32 ? 32 : 64;
+    T buf[64];
+    std::memcpy(buf, a, n * sizeof(T));
+    T pad = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                 : std::numeric_limits<T>::max();
+    for (int i = n; i < block; i++) buf[i] = pad;
+    sortBlock(buf, block);
+    std::memcpy(a, buf, n * sizeof(T));
+}
+
+// Merge sorted a[0..na) and b[0..nb) into out (out must not alias the inputs)
+template <class T>
+inline void mergeSorted(const T* a, size_t na, const T* b, size_t nb, T* out) {
+#ifdef SORTNET_X86
+    SimdLevel level = simdLevel();
+    if (level == AVX512) { mergeAvx512(a, na, b, nb, out); return; }
+    if (level == AVX2) { mergeAvx2(a, na, b, nb, out); return; }
+#endif
+    scalarMerge(a, na, b, nb, out);
+}
+
+// Bottom-up merge sort built only from the two kernels above:
+// 64-element network leaves, then vectorized merge passes.
+template <class T>
+inline void blockMergeSort(T* a, size_t n) {
+    const size_t B = 64;
+    for (size_t i = 0; i < n; i += B)
+        sortSmall(a + i, (int)std::min(B, n - i));
+    if (n <= B) return;
+
+    std::vector<T> tmp(n);
+    T* src = a;
+    T* dst = tmp.data();
+    for (size_t width = B; width < n; width *= 2) {
+        for (size_t lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = std::min(lo + width, n), hi = std::min(lo + 2 * width, n);
+            mergeSorted(src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+        }
+        std::swap(src, dst);
+    }
+    if (src != a) std::memcpy(a, src, n * sizeof(T));
+}
+
+} // namespace sortnet
+
+#endif
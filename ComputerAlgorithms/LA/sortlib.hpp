@@ -0,0 +1,270 @@
+#ifndef SORTLIB_HPP
+#define SORTLIB_HPP
+
+// Header-only quicksort engine shared by hybrid_sort.cpp, quicksort_compare.cpp,
+// quicksort.cpp and external_sort.cpp.
+//
+// Works on any random-access range with any comparator. Everything that used
+// to be copy-pasted between those files is a compile-time policy:
+//   Pivot      FirstPivot, LastPivot, RandomPivot, Median3Pivot
+//   Partition  LomutoPartition, HoarePartition, ThreeWayPartition
+//   BaseCase   InsertionBase<N>, NetworkBase<N> (cutoff can be overridden at runtime)
+//   Stats      NoStats (compiles away) or CountingStats
+//
+// Like introsort, a range still unsorted after 2*log2(n) partitioning levels
+// is heapsorted, so no pivot policy can push the work past O(n log n).
+// Experiments that want to see a policy's worst case pass UNLIMITED_DEPTH.
+//
+//     sortlib::quickSort(v.begin(), v.end());                       // defaults
+//     sortlib::quickSort<sortlib::FirstPivot, sortlib::HoarePartition,
+//                        sortlib::InsertionBase<1>>(v.begin(), v.end());
+//     sortlib::CountingStats stats;                                 // instrumented
+//     sortlib::quickSort(v.begin(), v.end(), std::less<int>(), stats,
+//                        sortlib::LastPivot(), sortlib::LomutoPartition(),
+//                        sortlib::InsertionBase<>{threshold});
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sort_network.hpp"
+
+namespace sortlib {
+
+// ----------------- Instrumentation -----------------
+struct NoStats {
+    void compare() {}
+    void swap() {}
+    void call() {}
+};
+
+struct CountingStats {
+    long long comparisons = 0;
+    long long swaps = 0;         // swaps and element shifts
+    long long recursiveCalls = 0; // partitioning steps
+    void compare() { comparisons++; }
+    void swap() { swaps++; }
+    void call() { recursiveCalls++; }
+};
+
+// Comparator wrapper that reports to Stats; inlines to a bare cmp() for NoStats
+template <class Cmp, class Stats>
+struct Counted {
+    Cmp& cmp;
+    Stats& stats;
+    template <class A, class B>
+    bool operator()(const A& a, const B& b) {
+        stats.compare();
+        return cmp(a, b);
+    }
+};
+
+template <class It, class Stats>
+inline void countedSwap(It a, It b, Stats& stats) {
+    stats.swap();
+    std::iter_swap(a, b);
+}
+
+// ----------------- Pivot selection -----------------
+// Each returns an iterator into [first, last)
+struct FirstPivot {
+    template <class It, class Cmp>
+    It operator()(It first, It, Cmp&) const { return first; }
+};
+
+struct LastPivot {
+    template <class It, class Cmp>
+    It operator()(It, It last, Cmp&) const { return last - 1; }
+};
+
+struct RandomPivot {
+    template <class It, class Cmp>
+    It operator()(It first, It last, Cmp&) const { return first + rand() % (last - first); }
+};
+
+// Median of first, middle and last (not counted as comparisons, as before)
+struct Median3Pivot {
+    template <class It, class Cmp>
+    It operator()(It first, It last, Cmp& cmp) const {
+        It mid = first + (last - first - 1) / 2, hi = last - 1;
+        const auto &a = *first, &b = *mid, &c = *hi;
+        if (cmp(b, a) != cmp(c, a)) return first;
+        if (cmp(a, b) != cmp(c, b)) return mid;
+        return hi;
+    }
+};
+
+// ----------------- Partition schemes -----------------
+// Each takes the chosen pivot and returns [lo, hi): the block already in its
+// final place. The engine recurses on [first, lo) and [hi, last).
+
+// Pivot moved to the end, single left-to-right scan (hybrid_sort / quicksort_compare)
+struct LomutoPartition {
+    template <class It, class Cmp, class Stats>
+    std::pair<It, It> operator()(It first, It last, It pivot, Cmp& cmp, Stats& stats) const {
+        It hi = last - 1;
+        if (pivot != hi) countedSwap(pivot, hi, stats);
+        It i = first;
+        for (It j = first; j != hi; ++j) {
+            stats.compare();
+            if (cmp(*j, *hi)) {
+                countedSwap(i, j, stats);
+                ++i;
+            }
+        }
+        countedSwap(i, hi, stats);
+        return {i, i + 1};
+    }
+};
+
+// Pivot moved to the front, two scans towards each other (quicksort.cpp / quicksort2.c)
+struct HoarePartition {
+    template <class It, class Cmp, class Stats>
+    std::pair<It, It> operator()(It first, It last, It pivot, Cmp& cmp, Stats& stats) const {
+        if (pivot != first) countedSwap(pivot, first, stats);
+        Counted<Cmp, Stats> less{cmp, stats};
+        It i = first, j = last - 1;
+        while (i < j) {
+            while (i < last - 1 && !less(*first, *i)) ++i;
+            while (j > first && less(*first, *j)) --j;
+            if (i < j) countedSwap(i, j, stats);
+        }
+        countedSwap(first, j, stats);
+        return {j, j + 1};
+    }
+};
+
+// Dutch national flag: keys equal to the pivot are finished in one pass,
+// so inputs with few distinct keys stay O(n log k)
+struct ThreeWayPartition {
+    template <class It, class Cmp, class Stats>
+    std::pair<It, It> operator()(It first, It last, It pivot, Cmp& cmp, Stats& stats) const {
+        auto p = *pivot;
+        Counted<Cmp, Stats> less{cmp, stats};
+        It lt = first, i = first, gt = last;
+        while (i < gt) {
+            if (less(*i, p)) countedSwap(lt++, i++, stats);
+            else if (less(p, *i)) countedSwap(i, --gt, stats);
+            else ++i;
+        }
+        return {lt, gt};
+    }
+};
+
+// ----------------- Base cases -----------------
+// Ranges of at most `cutoff` elements are not partitioned further.
+
+template <class It, class Cmp, class Stats>
+inline void insertionSort(It first, It last, Cmp& cmp, Stats& stats) {
+    if (last - first < 2) return;
+    for (It i = first + 1; i != last; ++i) {
+        auto key = std::move(*i);
+        It j = i;
+        while (j != first) {
+            stats.compare();
+            if (!cmp(key, *(j - 1))) break;
+            *j = std::move(*(j - 1));
+            stats.swap();
+            --j;
+        }
+        *j = std::move(key);
+    }
+}
+
+template <int N = 16>
+struct InsertionBase {
+    int cutoff = N;
+    template <class It, class Cmp, class Stats>
+    void operator()(It first, It last, Cmp& cmp, Stats& stats) const {
+        insertionSort(first, last, cmp, stats);
+    }
+};
+
+// Bitonic network from sort_network.hpp for contiguous int/float ranges under
+// the default ordering; anything else (or > 64 elements) uses insertion sort.
+// Network leaves are branch-free and are not counted.
+template <int N = 16>
+struct NetworkBase {
+    int cutoff = N;
+    template <class It, class Cmp, class Stats>
+    void operator()(It first, It last, Cmp& cmp, Stats& stats) const {
+        using V = typename std::iterator_traits<It>::value_type;
+        constexpr bool supported =
+            (std::is_same<V, int>::value || std::is_same<V, float>::value) &&
+            (std::is_same<It, V*>::value || std::is_same<It, typename std::vector<V>::iterator>::value) &&
+            (std::is_same<Cmp, std::less<V>>::value || std::is_same<Cmp, std::less<>>::value);
+        if constexpr (supported) {
+            if (last - first <= 64) {
+                sortnet::sortSmall(&*first, (int)(last - first));
+                return;
+            }
+        }
+        insertionSort(first, last, cmp, stats);
+    }
+};
+
+// ----------------- Engine -----------------
+const int UNLIMITED_DEPTH = -1;
+
+// Introsort budget: 2 * floor(log2(n)) partitioning levels
+inline int depthBudget(long long n) {
+    int depth = 0;
+    for (; n > 1; n >>= 1) depth += 2;
+    return depth;
+}
+
+template <class It, class Cmp, class Stats>
+inline void heapSort(It first, It last, Cmp& cmp, Stats& stats) {
+    Counted<Cmp, Stats> less{cmp, stats};
+    std::make_heap(first, last, less);
+    std::sort_heap(first, last, less);
+}
+
+// Recurses into the smaller side and loops on the larger one, so the stack
+// stays O(log n); ranges that use up depthLimit levels are heapsorted.
+template <class It, class Cmp, class Stats, class Pivot, class Partition, class BaseCase>
+void quickSort(It first, It last, Cmp cmp, Stats& stats, Pivot pivot, Partition partition, BaseCase base,
+               int depthLimit) {
+    while (last - first > 1) {
+        if (last - first <= base.cutoff) {
+            base(first, last, cmp, stats);
+            return;
+        }
+        if (depthLimit == 0) {
+            heapSort(first, last, cmp, stats);
+            return;
+        }
+        if (depthLimit > 0) depthLimit--;
+        stats.call();
+        It p = pivot(first, last, cmp);
+        std::pair<It, It> eq = partition(first, last, p, cmp, stats);
+        if (eq.first - first < last - eq.second) {
+            quickSort(first, eq.first, cmp, stats, pivot, partition, base, depthLimit);
+            first = eq.second;
+        } else {
+            quickSort(eq.second, last, cmp, stats, pivot, partition, base, depthLimit);
+            last = eq.first;
+        }
+    }
+}
+
+template <class It, class Cmp, class Stats, class Pivot, class Partition, class BaseCase>
+void quickSort(It first, It last, Cmp cmp, Stats& stats, Pivot pivot, Partition partition, BaseCase base) {
+    quickSort(first, last, cmp, stats, pivot, partition, base, depthBudget(last - first));
+}
+
+// Policies as template arguments, no instrumentation
+template <class Pivot = Median3Pivot, class Partition = LomutoPartition,
+          class BaseCase = InsertionBase<16>, class It, class Cmp = std::less<>>
+void quickSort(It first, It last, Cmp cmp = Cmp()) {
+    NoStats stats;
+    quickSort(first, last, cmp, stats, Pivot(), Partition(), BaseCase());
+}
+
+} // namespace sortlib
+
+#endif
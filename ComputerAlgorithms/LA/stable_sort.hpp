@@ -0,0 +1,156 @@
+#ifndef STABLE_SORT_HPP
+#define STABLE_SORT_HPP
+
+// Parallel stable merge sort for record arrays (vectors or plain arrays),
+// ordered by a projection (the key of each record) and a comparator on keys.
+//
+// Leaves of LEAF records are insertion sorted in parallel, then merged
+// bottom-up, ping-ponging between the array and a scratch buffer. While there
+// are more run pairs than threads each thread merges whole pairs; in the last
+// passes every merge is cut into one piece per thread with a merge-path split,
+// so all threads stay busy until the end. Equal keys keep their input order.
+//
+// StableSorter keeps its scratch buffer between calls, so repeated sorts
+// (e.g. a multi-key ordering done one key at a time) allocate only once:
+//
+//     sortlib::StableSorter<Record> sorter;
+//     sorter.sort(v.begin(), v.end(), [](const Record& r) { return r.minor; });
+//     sorter.sort(v.begin(), v.end(), [](const Record& r) { return r.major; });
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "sortlib.hpp"
+
+namespace sortlib {
+
+struct Identity {
+    template <class T>
+    const T& operator()(const T& x) const { return x; }
+};
+
+template <class T>
+class StableSorter {
+public:
+    static const int LEAF = 32;
+
+    template <class It, class Proj = Identity, class Cmp = std::less<>>
+    void sort(It first, It last, Proj proj = Proj(), Cmp cmp = Cmp()) {
+        long long n = last - first;
+        if (n < 2) return;
+        KeyCmp<Proj, Cmp> less{proj, cmp};
+        T* data = &*first;
+        if ((long long)buf.size() < n) buf.resize(n);
+        T* tmp = buf.data();
+        int threads = maxThreads();
+
+        long long leaves = (n + LEAF - 1) / LEAF;
+        #pragma omp parallel for schedule(static)
+        for (long long b = 0; b < leaves; b++) {
+            NoStats none;
+            KeyCmp<Proj, Cmp> c = less;
+            insertionSort(data + b * LEAF, data + std::min(n, (b + 1) * LEAF), c, none);
+        }
+
+        T* src = data;
+        T* dst = tmp;
+        for (long long width = LEAF; width < n; width *= 2) {
+            long long pairs = (n + 2 * width - 1) / (2 * width);
+            if (pairs >= threads) {
+                #pragma omp parallel for schedule(dynamic, 1)
+                for (long long p = 0; p < pairs; p++) {
+                    long long lo = p * 2 * width, mid = std::min(n, lo + width), hi = std::min(n, lo + 2 * width);
+                    KeyCmp<Proj, Cmp> c = less;
+                    mergeRange(src + lo, mid - lo, src + mid, hi - mid, dst + lo, c);
+                }
+            } else {
+                for (long long p = 0; p < pairs; p++) {
+                    long long lo = p * 2 * width, mid = std::min(n, lo + width), hi = std::min(n, lo + 2 * width);
+                    parallelMerge(src + lo, mid - lo, src + mid, hi - mid, dst + lo, less, threads);
+                }
+            }
+            std::swap(src, dst);
+        }
+
+        if (src != data) {
+            #pragma omp parallel for schedule(static)
+            for (long long i = 0; i < n; i++) data[i] = std::move(src[i]);
+        }
+    }
+
+    // Drop the scratch buffer
+    void release() { std::vector<T>().swap(buf); }
+
+private:
+    std::vector<T> buf;
+
+    template <class Proj, class Cmp>
+    struct KeyCmp {
+        Proj proj;
+        Cmp cmp;
+        bool operator()(const T& a, const T& b) { return cmp(proj(a), proj(b)); }
+    };
+
+    static int maxThreads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    // Stable: on equal keys the left run goes first
+    template <class Less>
+    static void mergeRange(T* a, long long na, T* b, long long nb, T* out, Less& less) {
+        T *aEnd = a + na, *bEnd = b + nb;
+        while (a != aEnd && b != bEnd) {
+            if (less(*b, *a)) *out++ = std::move(*b++);
+            else *out++ = std::move(*a++);
+        }
+        out = std::move(a, aEnd, out);
+        std::move(b, bEnd, out);
+    }
+
+    // Number of elements taken from a among the first diag outputs of the merge
+    template <class Less>
+    static long long mergePath(const T* a, long long na, const T* b, long long nb, long long diag, Less& less) {
+        long long lo = std::max(0LL, diag - nb), hi = std::min(diag, na);
+        while (lo < hi) {
+            long long mid = (lo + hi) / 2;
+            if (!less(b[diag - mid - 1], a[mid])) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // One merge cut into `parts` independent pieces of equal output size
+    template <class Less>
+    static void parallelMerge(T* a, long long na, T* b, long long nb, T* out, Less less, int parts) {
+        long long total = na + nb;
+        #pragma omp parallel for schedule(static) num_threads(parts)
+        for (int p = 0; p < parts; p++) {
+            Less c = less;
+            long long d0 = total * p / parts, d1 = total * (p + 1) / parts;
+            long long i0 = mergePath(a, na, b, nb, d0, c), i1 = mergePath(a, na, b, nb, d1, c);
+            mergeRange(a + i0, i1 - i0, b + (d0 - i0), (d1 - i1) - (d0 - i0), out + d0, c);
+        }
+    }
+};
+
+// One-off stable sort; keep a StableSorter around to reuse its buffer
+template <class It, class Proj = Identity, class Cmp = std::less<>>
+void stableSort(It first, It last, Proj proj = Proj(), Cmp cmp = Cmp()) {
+    StableSorter<typename std::iterator_traits<It>::value_type> sorter;
+    sorter.sort(first, last, proj, cmp);
+}
+
+} // namespace sortlib
+
+#endif
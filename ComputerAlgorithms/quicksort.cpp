@@ -1,33 +1,11 @@
 #include <bits/stdc++.h>
+#include "LA/sortlib.hpp"
 using namespace std;
 
-// Partition function using pivot at low index
-int partition(vector<int> &arr, int low, int high) {
-    int pivot = arr[low];
-    int i = low;
-    int j = high;
-
-    while (i < j) {
-        while (arr[i] <= pivot && i <= high - 1) i++;
-        while (arr[j] > pivot && j >= low + 1) j--;
-        if (i < j) swap(arr[i], arr[j]);
-    }
-    swap(arr[low], arr[j]);
-    return j;
-}
-
-// Recursive QuickSort
-void qs(vector<int> &arr, int low, int high) {
-    if (low < high) {
-        int pIndex = partition(arr, low, high);
-        qs(arr, low, pIndex - 1);
-        qs(arr, pIndex + 1, high);
-    }
-}
-
-// QuickSort wrapper
+// QuickSort wrapper: pivot at low index, Hoare-style two-scan partition
 vector<int> quickSort(vector<int> arr) {
-    qs(arr, 0, arr.size() - 1);
+    sortlib::quickSort<sortlib::FirstPivot, sortlib::HoarePartition, sortlib::InsertionBase<1>>(
+        arr.begin(), arr.end());
     return arr;
 }
 